@@ -8,845 +8,8423 @@
 #include <iomanip>
 #include <cstdlib>
 #include <memory>
+#include <limits>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <array>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <coroutine>
+#include <exception>
+#include <typeinfo>
 
 using namespace std;
 
 
-// Clasa de baza abstracta pentru pasi
-class Step
-{
-public:
-    virtual void execute() = 0;
-    virtual string getStepType() const = 0;
-    virtual string getDescription() const = 0;
-    virtual void writeDetailsToFile(ofstream& file) const = 0;
-    virtual ~Step() {}
-    virtual bool isNumberInputStep() const { return false; }
-};
-// Clasa pentru pasul de tip titlu
-class TitleStep : public Step
+// Clasa de baza abstracta pentru destinatiile de afisare (consola, fisier, mod silentios)
+class OutputSink
 {
-private:
-    string title;
-    string subtitle;
-
 public:
-    TitleStep(const string& title, const string& subtitle)
-        : title(title), subtitle(subtitle) {}
-    void execute() override
-    {
-
-        cout << "TITLE: ";
-        cin.ignore();
-        getline(cin, title);
-
-        cout << "SUBTITLE: ";
-        getline(cin, subtitle);
-    }
-
+    virtual void write(const char* data, size_t size) = 0;
+    virtual void flush() = 0;
+    virtual ~OutputSink() {}
 
-    std::string getStepType() const override
+    void write(const string& text)
     {
-        return "Title Step";
+        write(text.data(), text.size());
     }
 
-    std::string getDescription() const override
+    void writeLine(const string& line)
     {
-        return title + " - " + subtitle;
+        write(line.data(), line.size());
+        write("\n", 1);
     }
+};
 
-    void writeDetailsToFile(ofstream &file) const override
+// Destinatie pentru modul batch / silentios: tot ce se scrie este ignorat
+class NullSink : public OutputSink
 {
-    file << "TITLE Step" << endl;
-    file << "Title: " << title << endl;
-    file << "Subtitle: " << subtitle << endl;
-    file << endl;
-}
-
-
+public:
+    void write(const char*, size_t) override {}
+    void flush() override {}
 };
 
-// Clasa pentru pasul de tip text
-class TextStep : public Step
+// Destinatie cu buffer mare care scrie direct intr-un descriptor de fisier
+class FdSink : public OutputSink
 {
 private:
-    string title;
-    string text;
+    int fd;
+    bool ownsFd;
+    vector<char> buffer;
+    size_t used;
+
+    void writeAll(const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw runtime_error("Eroare la scrierea in descriptorul " + to_string(fd));
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
 
 public:
-    TextStep(const string& title, const string& text)
-        : title(title), text(text) {}
+    static const size_t DEFAULT_BUFFER_SIZE = 1 << 20;
 
-     void execute() override
+    FdSink(int descriptor, bool owns = false, size_t bufferSize = DEFAULT_BUFFER_SIZE)
+        : fd(descriptor), ownsFd(owns), buffer(bufferSize > 0 ? bufferSize : 1), used(0) {}
+
+    // Deschide (sau creeaza) un fisier si scrie in el prin buffer; cu append, continutul existent este pastrat
+    static FdSink* openFile(const string& path, size_t bufferSize = DEFAULT_BUFFER_SIZE, bool append = false)
+    {
+        int descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+        if (descriptor < 0)
+        {
+            throw runtime_error("Eroare la deschiderea fisierului " + path);
+        }
+        return new FdSink(descriptor, true, bufferSize);
+    }
+
+    void write(const char* data, size_t size) override
     {
+        if (used + size > buffer.size())
+        {
+            flush();
+        }
 
-        cout << "TITLE: ";
-        cin.ignore();
-        getline(cin, title);
+        // Blocurile mai mari decat bufferul merg direct in descriptor
+        if (size >= buffer.size())
+        {
+            writeAll(data, size);
+            return;
+        }
 
-        cout << "COPY: ";
-        getline(cin, text);
+        memcpy(buffer.data() + used, data, size);
+        used += size;
     }
 
-    std::string getStepType() const override
+    void flush() override
     {
-        return "Text Step";
+        // Pastram ordinea fata de ce a fost deja scris prin cout
+        if (fd == STDOUT_FILENO)
+        {
+            cout.flush();
+        }
+        writeAll(buffer.data(), used);
+        used = 0;
     }
 
-    std::string getDescription() const override
+    ~FdSink()
     {
-        return title + " - " + text;
+        try
+        {
+            flush();
+        }
+        catch (const exception&) {}
+
+        if (ownsFd)
+        {
+            ::close(fd);
+        }
     }
+};
 
-    void writeDetailsToFile(ofstream &file) const override
+unique_ptr<OutputSink> outputSink(new FdSink(STDOUT_FILENO));
+thread_local OutputSink* threadOutputSink = nullptr;  // Inlocuieste destinatia globala pe thread-ul curent (OutputScope)
+
+OutputSink& output()
 {
-    file << "TEXT Step" << endl;
-    file << "Title: " << title << endl;
-    file << "Text: " << text << endl;
-    file << endl;
+    return threadOutputSink ? *threadOutputSink : *outputSink;
 }
 
+void setOutputSink(OutputSink* sink)
+{
+    outputSink->flush();
+    outputSink.reset(sink);
+}
 
-};
-
-
+// Octetii cititi din fisiere sau scrisi in fisiere de thread-ul curent; tracer-ul ii atribuie pasului care ruleaza
+thread_local uint64_t fileIoBytes = 0;
 
+// Copiaza un fisier deschis in destinatia de afisare, pe blocuri mari
+void streamFileToSink(ifstream& inputFile, OutputSink& sink)
+{
+    vector<char> chunk(1 << 16);
+    while (inputFile.read(chunk.data(), chunk.size()) || inputFile.gcount() > 0)
+    {
+        sink.write(chunk.data(), static_cast<size_t>(inputFile.gcount()));
+        fileIoBytes += static_cast<uint64_t>(inputFile.gcount());
+    }
+    sink.flush();
+}
 
-// Clasa pentru pasul de tip text input
-class TextInputStep : public Step
+// Scriere compacta, in format binar little-endian, a starii pasilor
+class BinaryWriter
 {
 private:
-    string description;
-    string textInput;
+    string data;
 
 public:
-    TextInputStep(const string& desc, const string& textInput) : description(desc), textInput(textInput) {}
+    void writeU32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            data.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
 
-    void execute() override
+    void writeFloat(float value)
     {
+        // Pastram bitii exacti ai valorii
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        writeU32(bits);
+    }
+
+    void writeDouble(double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        writeU32(static_cast<uint32_t>(bits));
+        writeU32(static_cast<uint32_t>(bits >> 32));
+    }
 
-        cout << "DESCRIPTION: ";
-        cin.ignore();
-        getline(cin, description);
+    // Intreg fara semn pe 7 biti per octet; valorile mici ocupa un singur octet
+    void writeVarint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            data.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        data.push_back(static_cast<char>(value));
+    }
 
-        cout << "TEXT INPUT: ";
-        getline(cin, textInput);
+    // Codare zigzag, astfel incat numerele negative mici raman scurte
+    void writeSignedVarint(int64_t value)
+    {
+        writeVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
 
+    // Valorile intregi se scriu ca varint, celelalte cu bitii exacti ai float-ului
+    void writeNumber(float value)
+    {
+        if (std::isfinite(value) && value == std::trunc(value) && std::fabs(value) < 1e15f
+            && !(value == 0.0f && std::signbit(value)))
+        {
+            data.push_back(0);
+            writeSignedVarint(static_cast<int64_t>(value));
+        }
+        else
+        {
+            data.push_back(1);
+            writeFloat(value);
+        }
+    }
 
-        if (textInput.empty())
+    // Ca mai sus; valorile care nu incap exact intr-un float pastreaza toti bitii double-ului
+    void writeNumber(double value)
+    {
+        if (!std::isfinite(value) || static_cast<double>(static_cast<float>(value)) == value)
         {
-            throw runtime_error("Invalid input. Text input cannot be empty.");
+            writeNumber(static_cast<float>(value));
+        }
+        else
+        {
+            data.push_back(2);
+            writeDouble(value);
         }
     }
-    std::string getStepType() const override
+
+    void writeBool(bool value)
     {
-        return "Text Input Step";
+        data.push_back(value ? 1 : 0);
     }
 
-    std::string getDescription() const override
+    void writeString(const string& text)
     {
-        return description + " - " + textInput;
+        writeVarint(text.size());
+        data += text;
     }
-    void writeDetailsToFile(ofstream &file) const override
-{
-    file << "TEXT INPUT Step" << endl;
-    file << "Description: " << description << endl;
-    file << "Text Input: " << textInput << endl;
-    file << endl;
-}
-};
 
+    const string& buffer() const
+    {
+        return data;
+    }
+};
 
-class NumberInputStep : public Step
+// Citirea datelor scrise de BinaryWriter
+class BinaryReader
 {
 private:
-    string description;
-    float numberInput;
-    bool executed;
+    const string& data;
+    size_t position;
+
+    void require(size_t size) const
+    {
+        if (position + size > data.size())
+        {
+            throw runtime_error("Date binare incomplete.");
+        }
+    }
 
 public:
-    NumberInputStep(const string& desc) : description(desc), numberInput(0.0f), executed(false) {}
+    BinaryReader(const string& d) : data(d), position(0) {}
 
-    float getNumber() const
+    uint32_t readU32()
     {
-        return numberInput;
+        require(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            value |= static_cast<uint32_t>(static_cast<unsigned char>(data[position++])) << (8 * i);
+        }
+        return value;
     }
 
-    bool isExecuted() const {
-        return executed;
+    float readFloat()
+    {
+        uint32_t bits = readU32();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
     }
 
-    void execute() override {
-        // Implementation for NUMBER INPUT step
-        std::cout << "Introduceti o descriere: " << description << std::endl;
+    double readDouble()
+    {
+        uint64_t bits = readU32();
+        bits |= static_cast<uint64_t>(readU32()) << 32;
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
 
-        while (true)
+    uint64_t readVarint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
         {
-            std::cout << "Introduceti un numar: ";
-            if (std::cin >> numberInput)
-            {
-                // Verifica daca input-ul este valid
-                break;
-            }
-            else
+            require(1);
+            unsigned char byte = static_cast<unsigned char>(data[position++]);
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
             {
-                // Clear errorul de pe cin si ignora restul input-ului invalid
-                std::cin.clear();
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                std::cout << "Input invalid. Va rugam introduceti un numar valid." << std::endl;
+                return value;
             }
         }
+        throw runtime_error("Varint invalid.");
+    }
 
+    int64_t readSignedVarint()
+    {
+        uint64_t value = readVarint();
+        return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+    }
 
-        executed = true;
+    double readNumber()
+    {
+        require(1);
+        char tag = data[position++];
+        if (tag == 0)
+        {
+            return static_cast<double>(readSignedVarint());
+        }
+        if (tag == 1)
+        {
+            return readFloat();
+        }
+        if (tag == 2)
+        {
+            return readDouble();
+        }
+        throw runtime_error("Codare numerica necunoscuta.");
     }
 
-    std::string getStepType() const override
+    bool readBool()
     {
-        return "Number Input Step";
+        require(1);
+        return data[position++] != 0;
     }
 
-    std::string getDescription() const override
+    string readString()
+    {
+        uint64_t size = readVarint();
+        require(size);
+        string text = data.substr(position, size);
+        position += size;
+        return text;
+    }
+
+    bool atEnd() const
+    {
+        return position >= data.size();
+    }
+
+    size_t getPosition() const
     {
-        return description + " - " + std::to_string(numberInput);
+        return position;
     }
-    void writeDetailsToFile(ofstream &file) const override
+};
+
+// Forma text cea mai scurta care se citeste inapoi exact in aceeasi valoare
+string formatNumber(float value)
 {
-    file << "NUMBER INPUT Step" << endl;
-    file << "Description: " << description << endl;
-    file << "Number Input: " << numberInput << endl;
-    file << endl;  // Adaugă o linie goală între detalii
+    char buffer[32];
+    to_chars_result converted = to_chars(buffer, buffer + sizeof(buffer), value);
+    return string(buffer, converted.ptr);
 }
-};
 
+string formatNumber(double value)
+{
+    char buffer[32];
+    to_chars_result converted = to_chars(buffer, buffer + sizeof(buffer), value);
+    return string(buffer, converted.ptr);
+}
 
-// Clasa pentru pasul de tip calculus
 
-class CalculusStep : public Step
+// Compresie LZ77 simpla pentru un bloc: secvente de (literali, potrivire) cu lungimi varint si offset pe 16 biti
+class BlockCodec
 {
 private:
-    int steps;
-    string operation;
-    vector<NumberInputStep*> inputSteps;
-    float result;
+    static const int HASH_BITS = 14;
 
-public:
-   CalculusStep(int s, const string& op) : steps(s), operation(op), result(0.0f) {}
+    static uint32_t read32(const char* data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
 
+    static uint32_t hashOf(uint32_t value)
+    {
+        return (value * 2654435761U) >> (32 - HASH_BITS);
+    }
 
-    void addInputStep(NumberInputStep* step)
+    static void writeVarint(string& out, size_t value)
     {
-        inputSteps.push_back(step);
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
     }
 
-    void execute()
+    static size_t readVarint(const string& in, size_t& position)
     {
-        // Verificarea efectuării pasului NumberInputStep
-        for (const auto& inputStep : inputSteps)
+        size_t value = 0;
+        for (int shift = 0; position < in.size() && shift < 64; shift += 7)
         {
-            if (!inputStep->isExecuted())
+            unsigned char byte = static_cast<unsigned char>(in[position++]);
+            value |= static_cast<size_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
             {
-                cout << "Eroare: Trebuie executat NumberInputStep înainte de CalculusStep!" << endl;
-                return;
+                return value;
             }
         }
+        throw runtime_error("Bloc comprimat invalid.");
+    }
 
-        // Extragerea numărului de la pasul NumberInputStep
-        float userInput = inputSteps[0]->getNumber();
+public:
+    static string compress(const char* data, size_t size)
+    {
+        string out;
+        vector<long long> table(size_t(1) << HASH_BITS, -1);
+        size_t anchor = 0;
+        size_t position = 0;
 
-        // Solicitarea utilizatorului pentru introducerea unui alt număr
-        cout << "Introduceți un număr pentru operații: ";
-        float userSecondInput;
-        cin >> userSecondInput;
+        while (position + 4 <= size)
+        {
+            uint32_t current = read32(data + position);
+            uint32_t hash = hashOf(current);
+            long long candidate = table[hash];
+            table[hash] = static_cast<long long>(position);
 
-        // Afisarea meniului de operații
-        cout << "Alegeti o optiune:\n";
-        cout << "1. Adunare (+)\n";
-        cout << "2. Scădere (-)\n";
-        cout << "3. Înmulțire (*)\n";
-        cout << "4. Împărțire (/)\n";
-        cout << "5. Minim (min)\n";
-        cout << "6. Maxim (max)\n";
-        cout << "Introduceti numarul corespunzator operatiei pe care vreti sa o alegeti: ";
+            if (candidate >= 0 && position - candidate <= 0xFFFF && read32(data + candidate) == current)
+            {
+                size_t matchLength = 4;
+                while (position + matchLength < size && data[candidate + matchLength] == data[position + matchLength])
+                {
+                    matchLength++;
+                }
 
-        int operationChoice;
-        cin >> operationChoice;
-        cin.ignore();
+                writeVarint(out, position - anchor);
+                out.append(data + anchor, position - anchor);
+                writeVarint(out, matchLength);
+                size_t offset = position - static_cast<size_t>(candidate);
+                out.push_back(static_cast<char>(offset & 0xFF));
+                out.push_back(static_cast<char>(offset >> 8));
 
-        // Efectuarea calculelor in functie de operatia aleasa
-        switch (operationChoice)
-        {
-        case 1:
-            result = userInput + userSecondInput;
-            break;
-        case 2:
-            result = userInput - userSecondInput;
-            break;
-        case 3:
-            result = userInput * userSecondInput;
-            break;
-        case 4:
-            // Verificarea împărțirii la zero
-            if (userSecondInput != 0)
-            {
-                result = userInput / userSecondInput;
+                position += matchLength;
+                anchor = position;
             }
             else
             {
-                cout << "Eroare: Impartirea la zero nu este posibila. Va rugam sa incercati din nou." << endl;
-                return;
+                position++;
             }
-            break;
-        case 5:
-            result = min(userInput, userSecondInput);
-            break;
-        case 6:
-            result = max(userInput, userSecondInput);
-            break;
-        default:
-            cout << "Eroare: Operatie necunoscuta." << endl;
-            return;
         }
 
-        cout << "Rezultat: " << result << endl;
+        // Literalii ramasi, fara potrivire (lungime 0)
+        writeVarint(out, size - anchor);
+        out.append(data + anchor, size - anchor);
+        writeVarint(out, 0);
+        return out;
+    }
 
-        char continueChoice;
-        cout << "Vrei sa efectuezi alte operatii? (d/n): ";
-        cin >> continueChoice;
+    static string decompress(const string& in, size_t rawSize)
+    {
+        string out;
+        out.reserve(rawSize);
+        size_t position = 0;
+        while (position < in.size())
+        {
+            size_t literalLength = readVarint(in, position);
+            if (literalLength > in.size() - position || literalLength > rawSize - out.size())
+            {
+                throw runtime_error("Bloc comprimat invalid.");
+            }
+            out.append(in, position, literalLength);
+            position += literalLength;
 
-        if (continueChoice == 'd' || continueChoice == 'D')
+            size_t matchLength = readVarint(in, position);
+            if (matchLength == 0)
+            {
+                continue;
+            }
+            if (position + 2 > in.size())
+            {
+                throw runtime_error("Bloc comprimat invalid.");
+            }
+            size_t offset = static_cast<unsigned char>(in[position]) | (static_cast<size_t>(static_cast<unsigned char>(in[position + 1])) << 8);
+            position += 2;
+            if (offset == 0 || offset > out.size() || matchLength > rawSize - out.size())
+            {
+                throw runtime_error("Bloc comprimat invalid.");
+            }
+            // Copiere octet cu octet: potrivirea se poate suprapune cu ce se scrie
+            size_t start = out.size() - offset;
+            for (size_t i = 0; i < matchLength; ++i)
+            {
+                out.push_back(out[start + i]);
+            }
+        }
+        if (out.size() != rawSize)
         {
-            execute(); // Reapelarea functiei pentru a efectua alte operatii cu aceleasi numere
+            throw runtime_error("Bloc comprimat invalid.");
         }
+        return out;
     }
+};
 
-    std::string getStepType() const override
+// Fisier comprimat pe blocuri de 64 KiB, cu un index al blocurilor la final.
+// Format: "FLZ1", blocuri, index, offset index (8 octeti), "FLZI". Un bloc incepe cu tipul (2 necomprimat /
+// 3 comprimat), lungimea bruta, lungimea datelor si FNV-1a al datelor (cate 4 octeti), astfel incat indexul
+// poate fi refacut din blocuri daca scrierea a fost intrerupta inainte de index.
+struct CompressedBlock
+{
+    uint64_t fileOffset;
+    uint64_t rawOffset;
+    uint64_t rawSize;
+    uint64_t storedSize;
+};
+
+static const char COMPRESSED_MAGIC[] = "FLZ1";
+static const char COMPRESSED_INDEX_MAGIC[] = "FLZI";
+static const size_t COMPRESSED_BLOCK_HEADER = 13;
+
+uint32_t blockChecksum(const char* data, size_t size)
+{
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < size; ++i)
     {
-        return "Calculus Step";
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619U;
     }
+    return hash;
+}
 
-    std::string getDescription() const override
+uint32_t readLittleEndian32(const char* data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i)
     {
-
-        return std::to_string(steps) + " steps - " + operation;
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
     }
-    void writeDetailsToFile(ofstream &file) const override
-{
-    file << "CALCULUS Step" << endl;
-    file << "Result: " << result << endl;
-    file << endl;
+    return value;
 }
-};
-
-
 
-// Clasa pentru pasul de tip TEXT FILE input
-class TextFileInputStep : public Step
+// Citeste indexul de la finalul unui fisier comprimat; intoarce false daca lipseste sau este invalid
+bool readCompressedIndex(fstream& file, streamoff fileSize, vector<CompressedBlock>& blocks, uint64_t& indexOffset)
 {
-private:
-    std::string description;
-    std::string fileName;
-
-public:
-    TextFileInputStep(const std::string& desc, const std::string& file) : description(desc), fileName(file) {}
-
-    void execute() override
+    char trailer[12];
+    if (fileSize < 16)
+    {
+        return false;
+    }
+    file.seekg(fileSize - 12);
+    file.read(trailer, 12);
+    if (!file || memcmp(trailer + 8, COMPRESSED_INDEX_MAGIC, 4) != 0)
     {
-        std::cout << "Introduceti o descriere: " << description << std::endl;
-        std::cout << "Introduceti numele fisierului .txt: ";
-        std::cin >> fileName;
+        return false;
+    }
+    indexOffset = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        indexOffset |= static_cast<uint64_t>(static_cast<unsigned char>(trailer[i])) << (8 * i);
+    }
+    if (indexOffset < 4 || indexOffset > static_cast<uint64_t>(fileSize - 12))
+    {
+        return false;
+    }
 
-        std::ifstream fileStream(fileName);
-        std::string fileContent;
-        if (fileStream.is_open())
+    string index(static_cast<size_t>(fileSize - 12 - static_cast<streamoff>(indexOffset)), '\0');
+    file.seekg(static_cast<streamoff>(indexOffset));
+    file.read(&index[0], static_cast<streamsize>(index.size()));
+    try
+    {
+        BinaryReader reader(index);
+        uint64_t count = reader.readVarint();
+        uint64_t rawOffset = 0;
+        blocks.clear();
+        for (uint64_t i = 0; i < count; ++i)
         {
-            std::string line;
-            while (getline(fileStream, line))
+            CompressedBlock block;
+            block.fileOffset = reader.readVarint();
+            block.rawSize = reader.readVarint();
+            block.storedSize = reader.readVarint();
+            block.rawOffset = rawOffset;
+            if (block.fileOffset + block.storedSize > indexOffset)
             {
-                fileContent += line + "\n";
+                return false;
             }
-            fileStream.close();
+            rawOffset += block.rawSize;
+            blocks.push_back(block);
+        }
+    }
+    catch (const runtime_error&)
+    {
+        return false;
+    }
+    return true;
+}
 
-            std::cout << "Continutul fisierului:\n" << fileContent << std::endl;
+// Reface indexul din antetele blocurilor; dataEnd devine sfarsitul ultimului bloc intreg. Coada de dupa el
+// (un bloc sau un index scris pe jumatate) nu poate fi citita.
+void scanCompressedBlocks(fstream& file, streamoff fileSize, vector<CompressedBlock>& blocks, uint64_t& dataEnd)
+{
+    blocks.clear();
+    dataEnd = 4;
+    uint64_t rawOffset = 0;
+    string payload;
+    while (static_cast<streamoff>(dataEnd + COMPRESSED_BLOCK_HEADER) <= fileSize)
+    {
+        char header[COMPRESSED_BLOCK_HEADER];
+        file.seekg(static_cast<streamoff>(dataEnd));
+        file.read(header, sizeof(header));
+        if (!file)
+        {
+            break;
         }
-        else
+        uint32_t rawSize = readLittleEndian32(header + 1);
+        uint32_t storedSize = readLittleEndian32(header + 5);
+        if ((header[0] != 2 && header[0] != 3) || (header[0] == 2 && rawSize != storedSize)
+            || static_cast<streamoff>(dataEnd + sizeof(header) + storedSize) > fileSize)
+        {
+            break;
+        }
+        payload.resize(storedSize);
+        file.read(&payload[0], static_cast<streamsize>(storedSize));
+        if (!file || blockChecksum(payload.data(), payload.size()) != readLittleEndian32(header + 9))
         {
-            std::cerr << "Eroare: Fisierul nu a putut fi deschis." << std::endl;
+            break;
         }
+        blocks.push_back(CompressedBlock{dataEnd, rawOffset, rawSize, sizeof(header) + storedSize});
+        dataEnd += sizeof(header) + storedSize;
+        rawOffset += rawSize;
     }
+    file.clear();
+}
 
-    std::string getStepType() const override
+// Blocurile unui fisier comprimat, din index sau, daca indexul lipseste, din antetele blocurilor.
+// dataEnd este pozitia de unde se pot adauga blocuri noi. Intoarce false daca fisierul nu poate fi citit.
+bool loadCompressedBlocks(fstream& file, vector<CompressedBlock>& blocks, uint64_t& dataEnd)
+{
+    char magic[4];
+    file.seekg(0, ios::end);
+    streamoff fileSize = file.tellg();
+    file.seekg(0);
+    file.read(magic, 4);
+    if (!file || memcmp(magic, COMPRESSED_MAGIC, 4) != 0)
     {
-        return "Text File Input Step";
+        return false;
     }
-
-    std::string getDescription() const override
+    if (readCompressedIndex(file, fileSize, blocks, dataEnd))
     {
-        return description + " - " + fileName;
+        return true;
     }
-    void writeDetailsToFile(ofstream &file) const override
-{
-    file << "TEXT FILE INPUT Step" << endl;
-    file << "File: " << fileName << endl;
-    file << "Description: " << description << endl;
-    file << endl;
+    file.clear();
+    scanCompressedBlocks(file, fileSize, blocks, dataEnd);
+    return true;
 }
-};
 
-// Clasa pentru pasul de tip CSV FILE input
-class CSVFileInputStep : public Step
+// Scrie date text intr-un fisier comprimat; in modul append continua un fisier existent
+class CompressedWriter
 {
 private:
-    std::string description;
-    std::string fileName;
+    string path;
+    fstream file;
+    string pending;
+    vector<CompressedBlock> blocks;
+    uint64_t writeOffset;
+    uint64_t rawOffset;
+    bool indexWritten;  // Dupa writeOffset se afla indexul, care trebuie taiat inainte de blocul urmator
+    bool closed;
+
+    void writeBlock()
+    {
+        if (pending.empty())
+        {
+            return;
+        }
+        if (indexWritten)
+        {
+            // Altfel, o intrerupere dupa blocul nou ar lasa la final trailer-ul vechi, care ar indica date suprascrise
+            file.flush();
+            if (::truncate(path.c_str(), static_cast<off_t>(writeOffset)) != 0)
+            {
+                throw runtime_error("Eroare la scrierea fisierului " + path);
+            }
+            indexWritten = false;
+        }
+        string compressed = BlockCodec::compress(pending.data(), pending.size());
+        bool useCompressed = compressed.size() < pending.size();
+        const string& payload = useCompressed ? compressed : pending;
+
+        char header[COMPRESSED_BLOCK_HEADER];
+        header[0] = useCompressed ? 3 : 2;
+        uint32_t fields[3] = {static_cast<uint32_t>(pending.size()), static_cast<uint32_t>(payload.size()),
+                              blockChecksum(payload.data(), payload.size())};
+        for (int field = 0; field < 3; ++field)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                header[1 + 4 * field + i] = static_cast<char>((fields[field] >> (8 * i)) & 0xFF);
+            }
+        }
 
-public:
-    CSVFileInputStep(const std::string& desc, const std::string& file) : description(desc), fileName(file) {}
+        file.seekp(static_cast<streamoff>(writeOffset));
+        file.write(header, sizeof(header));
+        file.write(payload.data(), static_cast<streamsize>(payload.size()));
 
-    void execute() override
+        blocks.push_back(CompressedBlock{writeOffset, rawOffset, pending.size(), sizeof(header) + payload.size()});
+        writeOffset += sizeof(header) + payload.size();
+        rawOffset += pending.size();
+        pending.clear();
+    }
+
+    void writeIndex()
     {
-        std::cout << "Introduceti o descriere: " << description << std::endl;
-        std::cout << "Introduceti numele fisierului .csv: ";
-        std::cin >> fileName;
+        BinaryWriter index;
+        index.writeVarint(blocks.size());
+        for (const CompressedBlock& block : blocks)
+        {
+            index.writeVarint(block.fileOffset);
+            index.writeVarint(block.rawSize);
+            index.writeVarint(block.storedSize);
+        }
+        file.seekp(static_cast<streamoff>(writeOffset));
+        file.write(index.buffer().data(), static_cast<streamsize>(index.buffer().size()));
+        for (int i = 0; i < 8; ++i)
+        {
+            file.put(static_cast<char>((writeOffset >> (8 * i)) & 0xFF));
+        }
+        file.write(COMPRESSED_INDEX_MAGIC, 4);
+        file.flush();
+        indexWritten = true;
+    }
 
-        std::ifstream fileStream(fileName);
-        std::string fileContent;
-        if (fileStream.is_open())
+public:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    // Un fisier existent care nu poate fi citit nu este niciodata suprascris
+    CompressedWriter(const string& p, bool append = false)
+        : path(p), writeOffset(4), rawOffset(0), indexWritten(false), closed(false)
+    {
+        if (append)
         {
-            std::string line;
-            while (getline(fileStream, line))
+            file.open(path, ios::in | ios::out | ios::binary);
+            file.seekg(0, ios::end);
+            if (file.is_open() && file.tellg() > 0)
+            {
+                uint64_t dataEnd = 0;
+                if (!loadCompressedBlocks(file, blocks, dataEnd))
+                {
+                    throw runtime_error("Fisierul " + path + " nu este un fisier comprimat valid si nu a fost modificat.");
+                }
+                // Indexul vechi (sau coada scrisa pe jumatate) este inlocuit de blocurile noi si rescris la inchidere
+                file.close();
+                if (::truncate(path.c_str(), static_cast<off_t>(dataEnd)) != 0)
+                {
+                    throw runtime_error("Eroare la deschiderea fisierului " + path);
+                }
+                file.open(path, ios::in | ios::out | ios::binary);
+                writeOffset = dataEnd;
+                for (const CompressedBlock& block : blocks)
+                {
+                    rawOffset += block.rawSize;
+                }
+            }
+            else
             {
-                fileContent += line + "\n";
+                file.close();
             }
-            fileStream.close();
+        }
 
-            std::cout << "Continutul fisierului:\n" << fileContent << std::endl;
+        if (!file.is_open())
+        {
+            file.open(path, ios::out | ios::trunc | ios::binary);
+            file.write(COMPRESSED_MAGIC, 4);
         }
-        else
+        if (!file)
         {
-            std::cerr << "Eroare: Fisierul nu a putut fi deschis." << std::endl;
+            throw runtime_error("Eroare la deschiderea fisierului " + path);
         }
     }
 
-     std::string getStepType() const override
+    void write(const string& text)
     {
-        return "CSV File Input Step";
+        size_t position = 0;
+        while (position < text.size())
+        {
+            size_t chunk = min(BLOCK_SIZE - pending.size(), text.size() - position);
+            pending.append(text, position, chunk);
+            position += chunk;
+            if (pending.size() == BLOCK_SIZE)
+            {
+                writeBlock();
+            }
+        }
     }
 
-    std::string getDescription() const override
+    // Scrie blocul curent si indexul fara sa inchida fisierul; pana la scrierea urmatoare fisierul este complet
+    void checkpoint()
     {
-        return description + " - " + fileName;
+        if (closed)
+        {
+            return;
+        }
+        writeBlock();
+        writeIndex();
+    }
+
+    // Scrie blocul curent si indexul, astfel incat fisierul sa poata fi citit
+    void close()
+    {
+        if (closed)
+        {
+            return;
+        }
+        closed = true;
+        writeBlock();
+        writeIndex();
+        file.close();
     }
-    void writeDetailsToFile(ofstream &file) const override
-{
-    file << "CSV FILE INPUT Step" << endl;
-    file << "File name: " << fileName << endl;
-    file << "Description: " << description << endl;
-    file << endl;
-}
 
+    ~CompressedWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const exception&) {}
+    }
 };
 
-// Clasa pentru pasul DISPLAY
-class DisplayStep : public Step
+// Citeste intervale din fisierul comprimat, decomprimand doar blocurile necesare
+class CompressedReader
 {
 private:
-    int step;
-    string content;
-    string fileName;
-
-public:
-    DisplayStep(int s, const string& c, const string& file) : step(s), content(c), fileName(file) {}
+    fstream file;
+    vector<CompressedBlock> blocks;
+    uint64_t dataEnd;
 
+    string readBlock(const CompressedBlock& block)
+    {
+        string stored(static_cast<size_t>(block.storedSize), '\0');
+        file.seekg(static_cast<streamoff>(block.fileOffset));
+        file.read(&stored[0], static_cast<streamsize>(stored.size()));
+        if (!file || stored.size() < COMPRESSED_BLOCK_HEADER)
+        {
+            throw runtime_error("Bloc comprimat incomplet.");
+        }
+        char type = stored[0];
+        if ((type != 2 && type != 3)
+            || blockChecksum(stored.data() + COMPRESSED_BLOCK_HEADER, stored.size() - COMPRESSED_BLOCK_HEADER) != readLittleEndian32(stored.data() + 9))
+        {
+            throw runtime_error("Bloc comprimat invalid.");
+        }
+        string payload = stored.substr(COMPRESSED_BLOCK_HEADER);
+        return type == 3 ? BlockCodec::decompress(payload, static_cast<size_t>(block.rawSize)) : payload;
+    }
 
-    void execute()
+public:
+    CompressedReader(const string& path) : dataEnd(0)
     {
-        cout << "Executarea pasului DISPLAY pentru TEXT FILE (tastati 1) sau pentru CSV FILE (tastati 2) : " << step << endl;
+        file.open(path, ios::in | ios::binary);
+        if (!file.is_open() || !loadCompressedBlocks(file, blocks, dataEnd))
+        {
+            throw runtime_error("Fisierul " + path + " nu este un fisier comprimat valid.");
+        }
+    }
 
-        int fileTypeChoice;
-        cout << "Selectati tipul fisierului pentru afisare (1 - TEXT FILE, 2 - CSV FILE): ";
-        cin >> fileTypeChoice;
+    // Verifica daca un fisier incepe cu antetul formatului comprimat
+    static bool isCompressed(const string& path)
+    {
+        ifstream file(path, ios::binary);
+        char magic[4];
+        return file.read(magic, 4) && memcmp(magic, COMPRESSED_MAGIC, 4) == 0;
+    }
 
-        ifstream inputFile(fileName);
+    uint64_t size() const
+    {
+        return blocks.empty() ? 0 : blocks.back().rawOffset + blocks.back().rawSize;
+    }
 
-        if (!inputFile)
+    string readRange(uint64_t offset, uint64_t length)
+    {
+        string result;
+        uint64_t end = min(size(), offset + length);
+        // Primul bloc care contine offset-ul, prin cautare binara in index
+        auto first = upper_bound(blocks.begin(), blocks.end(), offset, [](uint64_t value, const CompressedBlock& block)
         {
-            throw runtime_error("Eroare la deschiderea fisierului " + fileName);
-        }
-
-        if (fileTypeChoice == 1)
+            return value < block.rawOffset + block.rawSize;
+        });
+        for (auto block = first; block != blocks.end() && block->rawOffset < end; ++block)
         {
-            // Afișare conținut TEXT FILE
-            string line;
-            while (getline(inputFile, line))
-            {
-                cout << line << endl;
-            }
+            string raw = readBlock(*block);
+            uint64_t from = max(offset, block->rawOffset) - block->rawOffset;
+            uint64_t to = min(end, block->rawOffset + block->rawSize) - block->rawOffset;
+            result.append(raw, static_cast<size_t>(from), static_cast<size_t>(to - from));
         }
-        else if (fileTypeChoice == 2)
+        return result;
+    }
+
+    // Trimite tot continutul in destinatia de afisare, bloc cu bloc
+    void streamTo(OutputSink& sink)
+    {
+        for (const CompressedBlock& block : blocks)
         {
-            // Afișare conținut CSV FILE
-            string csvLine;
-            while (getline(inputFile, csvLine))
-            {
-                cout << csvLine << endl;
-            }
+            sink.write(readBlock(block));
         }
-        else
+        sink.flush();
+    }
+};
+
+// Verificarile formatului comprimat (--self-test): codecul si recuperarea fisierelor fara index.
+// Intoarce numarul verificarilor esuate; fiecare verificare este afisata cu rezultatul ei.
+int selfTestCompression(ostream& out)
+{
+    int failures = 0;
+    auto check = [&](const string& name, bool passed)
+    {
+        out << "  " << (passed ? "OK     " : "ESUAT  ") << name << "\n";
+        if (!passed)
         {
-            throw runtime_error("Selectie invalida a tipului de fisier.");
+            failures++;
         }
+    };
+    auto roundTrips = [](const string& data)
+    {
+        string compressed = BlockCodec::compress(data.data(), data.size());
+        return BlockCodec::decompress(compressed, data.size()) == data;
+    };
 
-        inputFile.close();
+    // Date de test deterministe: text repetitiv, octeti aleatori si potriviri care se suprapun
+    mt19937 random(12345);
+    string text;
+    while (text.size() < 3 * CompressedWriter::BLOCK_SIZE + 777)
+    {
+        text += "2024-05-01 12:00:00 proces" + to_string(random() % 50) + " finalizat " + to_string(random() % 100000) + "us\n";
     }
-     std::string getStepType() const override
+    string periodic;
+    while (periodic.size() < 70000)
     {
-        return "Display Step";
+        periodic += "abc";
     }
-
-    std::string getDescription() const override
+    string noise(100000, '\0');
+    for (char& c : noise)
     {
-        return content + " - " + fileName;
+        c = static_cast<char>(random() & 0xFF);
     }
-    void writeDetailsToFile(ofstream &file) const override
-{
-    file << "DISPLAY Step" << endl;
-    file << "file name: " << fileName << endl;
-    file << "Content: " << content << endl;
-    file << endl;  // Adaugă o linie goală între detalii
-}
 
-};
-
-// Clasa pentru pasul de tip OUTPUT
-class OutputStep : public Step
-{
-private:
-    int stepNumber;
-    std::string fileName;
-    std::string title;
-    std::string description;
+    check("codec: sir gol", roundTrips(""));
+    check("codec: sub 4 octeti", roundTrips("abc"));
+    check("codec: text repetitiv", roundTrips(text.substr(0, CompressedWriter::BLOCK_SIZE)));
+    check("codec: potrivire suprapusa", roundTrips(string(70000, 'a')) && roundTrips(periodic));
+    check("codec: date necompresibile", roundTrips(noise));
+    bool rejected = false;
+    try
+    {
+        string compressed = BlockCodec::compress(text.data(), 4096);
+        compressed[compressed.size() / 2] ^= 0x5A;
+        rejected = BlockCodec::decompress(compressed, 4096) != text.substr(0, 4096);
+    }
+    catch (const runtime_error&)
+    {
+        rejected = true;
+    }
+    check("codec: bloc corupt respins", rejected);
 
-public:
-    OutputStep(int step, const std::string& file, const std::string& t, const std::string& desc)
-        : stepNumber(step), fileName(file), title(t), description(desc) {}
+    char pathTemplate[] = "/tmp/flz-self-test-XXXXXX";
+    int fd = mkstemp(pathTemplate);
+    if (fd < 0)
+    {
+        check("fisier temporar", false);
+        return failures;
+    }
+    ::close(fd);
+    string path = pathTemplate;
+    string contents = text + noise;
+    auto readAll = [&]()
+    {
+        CompressedReader reader(path);
+        return reader.readRange(0, reader.size());
+    };
+    auto fileSize = [&]()
+    {
+        struct stat info;
+        return stat(path.c_str(), &info) == 0 ? static_cast<off_t>(info.st_size) : static_cast<off_t>(0);
+    };
 
-    void execute() override
+    try
     {
-        std::cout << "Introduceti numele fisierului de iesire .txt: ";
-        std::cin >> fileName;
+        {
+            CompressedWriter writer(path);
+            writer.write(contents);
+        }
+        check("fisier: citire completa", readAll() == contents);
+        {
+            CompressedReader reader(path);
+            uint64_t boundary = CompressedWriter::BLOCK_SIZE;
+            check("fisier: interval peste granita blocurilor",
+                  reader.readRange(boundary - 10, 20) == contents.substr(static_cast<size_t>(boundary - 10), 20));
+        }
 
-        std::ofstream fileStream(fileName);
-        if (fileStream.is_open())
+        // Indexul taiat pe jumatate: blocurile sunt regasite din antetele lor
+        off_t complete = fileSize();
+        if (::truncate(path.c_str(), complete - 6) != 0)
         {
-            fileStream << "Title: " << title << "\n";
-            fileStream << "Description: " << description << "\n";
-            fileStream << "Step Number: " << stepNumber << "\n";
-            fileStream.close();
+            throw runtime_error("Eroare la taierea fisierului " + path);
+        }
+        check("recuperare: index incomplet", readAll() == contents);
 
-            std::cout << "Fisierul de iesire a fost generat cu succes." << std::endl;
+        // Ultimul bloc taiat: raman blocurile intregi de dinaintea lui
+        {
+            CompressedWriter writer(path);
+            writer.write(text);
+            writer.checkpoint();
         }
-        else
+        off_t withIndex = fileSize();
+        if (::truncate(path.c_str(), withIndex / 2) != 0)
         {
-            std::cerr << "Eroare: Fisierul de iesire nu a putut fi creat." << std::endl;
+            throw runtime_error("Eroare la taierea fisierului " + path);
         }
-    }
+        string recovered = readAll();
+        check("recuperare: bloc incomplet", !recovered.empty() && recovered.size() < text.size() && text.compare(0, recovered.size(), recovered) == 0);
 
+        // Adaugarea dupa o intrerupere continua de la ultimul bloc intreg si rescrie indexul
+        {
+            CompressedWriter writer(path, true);
+            writer.write("linie noua\n");
+        }
+        check("recuperare: adaugare dupa intrerupere", readAll() == recovered + "linie noua\n");
 
-    std::string getStepType() const override
-    {
-        return "Output Step";
+        ofstream(path, ios::trunc) << "nu este comprimat\n";
+        bool refused = false;
+        try
+        {
+            CompressedWriter writer(path, true);
+        }
+        catch (const runtime_error&)
+        {
+            refused = true;
+        }
+        ifstream untouched(path);
+        string line;
+        getline(untouched, line);
+        check("adaugare: fisier strain refuzat si nemodificat", refused && line == "nu este comprimat");
     }
-
-    std::string getDescription() const override
+    catch (const exception& e)
     {
-        return std::to_string(stepNumber) + " - " + fileName + " - " + title + " - " + description;
+        check(string("exceptie neasteptata: ") + e.what(), false);
     }
-    void writeDetailsToFile(ofstream &file) const override
-{
-    file << "OUTPUT Step" << endl;
-    file << "Title: " << title << endl;
-    file << "Text: " << description << endl;
-    file << endl;
+    remove(path.c_str());
+    return failures;
 }
 
-};
-
-
-class Flow
+// Jurnal comprimat al rularilor: o linie per rulare terminata (data, proces, stare, durata)
+class RunJournal
 {
 private:
-    string name;
-    vector<Step*> steps;
-    time_t creationTime;
-    int startCount;  // Numărul de porniri ale procesului
-    int completionCount;  // Numărul de finalizări ale procesului
-    vector<int> skippedScreens;  // Vector pentru a ține evidența ecranelor sărite
-    vector<int> errorScreens;  // Vector pentru a ține evidența ecranelor de eroare
-    float totalErrors;  // Numărul total de erori pentru analiza medie
-    bool isCompleted;  // Flag pentru a verifica dacă procesul a fost finalizat
+    CompressedWriter writer;
+    mutex journalMutex;
+    chrono::steady_clock::time_point lastCheckpoint;
 
 public:
-    Flow(const string& n) : name(n), startCount(0), completionCount(0), totalErrors(0), isCompleted(false)
+    // Cat de des se scriu pe disc blocul curent si indexul; o oprire brusca pierde cel mult atatea rulari
+    static constexpr chrono::seconds CHECKPOINT_INTERVAL{1};
+
+    RunJournal(const string& path) : writer(path, true), lastCheckpoint(chrono::steady_clock::now()) {}
+
+    void record(const string& flowName, bool completed, long long durationMicros)
     {
-        creationTime = time(nullptr);
+        time_t now = time(nullptr);
+        tm local;
+        localtime_r(&now, &local);  // Apelat din worker-i; localtime foloseste o structura statica comuna
+        char timestamp[32];
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &local);
+        string line = string(timestamp) + " " + flowName + " " + (completed ? "finalizat" : "esuat") + " "
+                      + to_string(durationMicros) + "us\n";
+        lock_guard<mutex> guard(journalMutex);
+        writer.write(line);
+        chrono::steady_clock::time_point current = chrono::steady_clock::now();
+        if (current - lastCheckpoint >= CHECKPOINT_INTERVAL)
+        {
+            writer.checkpoint();
+            lastCheckpoint = current;
+        }
     }
-    void addStep(Step* step)
+};
+
+unique_ptr<RunJournal> runJournal;  // Activat cu --journal <fisier>
+
+
+// Cache marginit (LRU) pentru rezultatele pasilor deterministi, cu salvare optionala pe disc
+class ResultCache
+{
+private:
+    struct Entry
     {
-        steps.push_back(step);
-    }
-    const vector<Step*>& getSteps() const
+        string key;
+        string value;
+    };
+
+    atomic<bool> enabled;  // Citit fara lock de fiecare rulare, inainte de cautare
+    size_t capacityBytes;
+    size_t usedBytes;
+    list<Entry> entries;  // Cele mai recent folosite sunt la inceput
+    unordered_map<string, list<Entry>::iterator> index;
+    mutable mutex cacheMutex;
+
+    // Fisierele de pe disc au lock-ul lor, ca citirile si scrierile sa nu blocheze cautarile in memorie
+    string spillDirectory;  // Gol daca intrarile eliminate nu se salveaza pe disc
+    list<pair<string, size_t>> spilled;  // Fisierele scrise, cu dimensiunea lor; cele mai vechi la final
+    unordered_map<string, list<pair<string, size_t>>::iterator> spilledIndex;
+    size_t spilledBytes;
+    mutable mutex spillMutex;
+
+    static const size_t SPILL_FACTOR = 4;  // Discul pastreaza de cel mult atatea ori capacitatea din memorie
+
+    string spillPath(const string& key) const
     {
-        return steps;
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.cache", static_cast<unsigned long long>(hashKey(key)));
+        return spillDirectory + "/" + name;
     }
 
+    // Apelate cu spillMutex blocat
+    void forgetSpilled(const string& path)
+    {
+        auto found = spilledIndex.find(path);
+        if (found != spilledIndex.end())
+        {
+            spilledBytes -= found->second->second;
+            spilled.erase(found->second);
+            spilledIndex.erase(found);
+        }
+    }
 
-    void run()
+    void spill(const Entry& entry)
     {
-        startCount++;
-        for (Step* step : steps)
+        BinaryWriter writer;
+        writer.writeString(entry.key);
+        writer.writeString(entry.value);
+        string path = spillPath(entry.key);
         {
-            if (!isCompletedSuccessfully())
+            ofstream spillFile(path, ios::binary | ios::trunc);
+            if (!spillFile.write(writer.buffer().data(), writer.buffer().size()))
             {
-                step->execute();
+                spillFile.close();
+                remove(path.c_str());
+                return;
             }
         }
-        completionCount++;
-        isCompleted = true;
+        forgetSpilled(path);
+        spilled.emplace_front(path, writer.buffer().size());
+        spilledIndex[path] = spilled.begin();
+        spilledBytes += writer.buffer().size();
+
+        while (spilledBytes > capacityBytes * SPILL_FACTOR && spilled.size() > 1)
+        {
+            remove(spilled.back().first.c_str());
+            forgetSpilled(spilled.back().first);
+        }
     }
 
-    void analyze() const
+    // Intrarea salvata este mutata inapoi in memorie, deci fisierul ei este sters
+    bool takeSpilled(const string& key, string& value)
     {
-        cout << "Analiza procesului " << name << ":\n";
-        cout << "  - Numarul de porniri: " << startCount << endl;
-        cout << "  - Numarul de finalizari: " << completionCount << endl;
-
-        if (completionCount > 0)
+        string path = spillPath(key);
+        ifstream spillFile(path, ios::binary);
+        if (!spillFile.is_open())
         {
-            float averageErrors = totalErrors / completionCount;
-            cout << "  - Numarul mediu de erori per proces finalizat: " << averageErrors << endl;
+            return false;
         }
-        else
+        string data((istreambuf_iterator<char>(spillFile)), istreambuf_iterator<char>());
+        spillFile.close();
+        try
         {
-            cout << "  - Procesul nu a fost finalizat niciodata.\n";
+            BinaryReader reader(data);
+            if (reader.readString() != key)
+            {
+                return false;  // Coliziune de hash
+            }
+            value = reader.readString();
         }
-
-        cout << "  - Numarul total de ecrane sarite: " << skippedScreens.size() << endl;
-        cout << "  - Numarul total de ecrane de eroare: " << errorScreens.size() << endl;
-
-        // Alte informații de analiză pot fi adăugate aici
+        catch (const runtime_error&)
+        {
+            return false;
+        }
+        remove(path.c_str());
+        forgetSpilled(path);
+        return true;
     }
 
-    void displayCreationTime() const
+    // Apelata cu cacheMutex blocat; intrarile eliminate sunt intoarse in evicted, pentru spillEvicted
+    void insert(const string& key, const string& value, vector<Entry>& evicted)
     {
-        cout << "Procesul " << name << " a fost creat la: " << put_time(localtime(&creationTime), "%Y-%m-%d %H:%M:%S") << endl;
-    }
+        auto found = index.find(key);
+        if (found != index.end())
+        {
+            usedBytes -= found->second->key.size() + found->second->value.size();
+            entries.erase(found->second);
+            index.erase(found);
+        }
 
-    void markScreenSkipped(int screenNumber)
-    {
-        skippedScreens.push_back(screenNumber);
+        entries.push_front(Entry{key, value});
+        index[key] = entries.begin();
+        usedBytes += key.size() + value.size();
+
+        while (usedBytes > capacityBytes && entries.size() > 1)
+        {
+            Entry& oldest = entries.back();
+            usedBytes -= oldest.key.size() + oldest.value.size();
+            index.erase(oldest.key);
+            evicted.push_back(move(oldest));
+            entries.pop_back();
+        }
+    }
+
+    // Dupa eliberarea cacheMutex: o valoare noua face inutila copia de pe disc, iar cele eliminate sunt salvate
+    void spillEvicted(const string& storedKey, const vector<Entry>& evicted)
+    {
+        lock_guard<mutex> guard(spillMutex);
+        if (spillDirectory.empty())
+        {
+            return;
+        }
+        string stale = spillPath(storedKey);
+        if (spilledIndex.count(stale) != 0)
+        {
+            remove(stale.c_str());
+            forgetSpilled(stale);
+        }
+        for (const Entry& entry : evicted)
+        {
+            spill(entry);
+        }
+    }
+
+public:
+    ResultCache() : enabled(false), capacityBytes(64 << 20), usedBytes(0), spilledBytes(0) {}
+
+    // FNV-1a pe 64 de biti
+    static uint64_t hashKey(const string& key)
+    {
+        uint64_t hash = 1469598103934665603ULL;
+        for (unsigned char c : key)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    void enable(size_t capacity)
+    {
+        lock_guard<mutex> guard(cacheMutex);
+        enabled = true;
+        capacityBytes = capacity;
+    }
+
+    // Activeaza cache-ul (cu capacitatea curenta) si salvarea intrarilor eliminate in directorul dat
+    void enableSpill(const string& directory)
+    {
+        {
+            lock_guard<mutex> guard(cacheMutex);
+            enabled = true;
+        }
+        lock_guard<mutex> guard(spillMutex);
+        spillDirectory = directory;
+    }
+
+    bool isEnabled() const
+    {
+        return enabled;
+    }
+
+    size_t getCapacity() const
+    {
+        lock_guard<mutex> guard(cacheMutex);
+        return capacityBytes;
+    }
+
+    size_t getUsedBytes() const
+    {
+        lock_guard<mutex> guard(cacheMutex);
+        return usedBytes;
+    }
+
+    bool lookup(const string& key, string& value)
+    {
+        {
+            lock_guard<mutex> guard(cacheMutex);
+            auto found = index.find(key);
+            if (found != index.end())
+            {
+                entries.splice(entries.begin(), entries, found->second);
+                value = found->second->value;
+                return true;
+            }
+        }
+        {
+            lock_guard<mutex> guard(spillMutex);
+            if (spillDirectory.empty() || !takeSpilled(key, value))
+            {
+                return false;
+            }
+        }
+        vector<Entry> evicted;
+        {
+            lock_guard<mutex> guard(cacheMutex);
+            insert(key, value, evicted);
+        }
+        spillEvicted(key, evicted);
+        return true;
+    }
+
+    void store(const string& key, const string& value)
+    {
+        vector<Entry> evicted;
+        {
+            lock_guard<mutex> guard(cacheMutex);
+            if (key.size() + value.size() > capacityBytes)
+            {
+                return;
+            }
+            insert(key, value, evicted);
+        }
+        spillEvicted(key, evicted);
+    }
+};
+
+ResultCache resultCache;
+
+long long fileSizeOf(const string& fileName)
+{
+    struct stat info;
+    return stat(fileName.c_str(), &info) == 0 ? static_cast<long long>(info.st_size) : -1;
+}
+
+// Cheia unui fisier include data modificarii (cu nanosecunde) si dimensiunea, ca un fisier schimbat sa nu fie
+// luat din cache, chiar daca a fost rescris in aceeasi secunda cu aceeasi dimensiune
+string fileCacheKey(const string& fileName)
+{
+    struct stat info;
+    if (stat(fileName.c_str(), &info) != 0)
+    {
+        return "";
+    }
+    long long modified = static_cast<long long>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+    return "file:" + fileName + ":" + to_string(modified) + ":" + to_string(static_cast<long long>(info.st_size));
+}
+
+// Citeste continutul unui fisier, folosind cache-ul de rezultate daca useCache este setat
+bool readFileCached(const string& fileName, string& content, bool useCache)
+{
+    string key = useCache ? fileCacheKey(fileName) : "";
+    if (!key.empty() && resultCache.lookup(key, content))
+    {
+        return true;
+    }
+
+    ifstream fileStream(fileName);
+    if (!fileStream.is_open())
+    {
+        return false;
+    }
+    ostringstream buffer;
+    buffer << fileStream.rdbuf();
+    content = buffer.str();
+    fileIoBytes += content.size();
+
+    if (!key.empty())
+    {
+        resultCache.store(key, content);
+    }
+    return true;
+}
+
+// Indexul rar al inceputurilor de rand dintr-un fisier: un punct de reper la fiecare STRIDE randuri, ca un fisier
+// foarte mare sa aiba un index mic. Un rand oarecare este gasit cu o singura pozitionare pe reperul anterior,
+// urmata de cel mult STRIDE - 1 randuri sarite.
+class LineIndex
+{
+public:
+    struct Position
+    {
+        uint64_t line;  // De la 0
+        uint64_t offset;
+    };
+
+private:
+    static const uint64_t STRIDE = 1024;
+    static const uint64_t MIN_CHUNK_BYTES = 8 << 20;  // Fisierele mai mici sunt indexate pe un singur thread
+
+    vector<Position> checkpoints;  // Ordonate dupa rand
+    uint64_t lineCount = 0;
+
+    // Reperele unei bucati [begin, end): randurile care incep dupa un '\n' din bucata (plus randul 0 pentru prima),
+    // numerotate local; numerotarea globala se afla abia dupa ce toate bucatile si-au numarat randurile
+    static uint64_t indexChunk(int fd, uint64_t begin, uint64_t end, uint64_t fileSize, vector<Position>& local)
+    {
+        uint64_t count = 0;
+        auto lineStart = [&](uint64_t offset)
+        {
+            if (count % STRIDE == 0)
+            {
+                local.push_back(Position{count, offset});
+            }
+            count++;
+        };
+        if (begin == 0 && fileSize > 0)
+        {
+            lineStart(0);
+        }
+        vector<char> buffer(1 << 20);
+        for (uint64_t position = begin; position < end;)
+        {
+            ssize_t bytesRead = pread(fd, buffer.data(), static_cast<size_t>(min<uint64_t>(buffer.size(), end - position)),
+                                      static_cast<off_t>(position));
+            if (bytesRead <= 0)
+            {
+                break;
+            }
+            const char* data = buffer.data();
+            const char* limit = data + bytesRead;
+            for (const char* newline = data; (newline = static_cast<const char*>(memchr(newline, '\n', limit - newline))); ++newline)
+            {
+                uint64_t next = position + static_cast<uint64_t>(newline - data) + 1;
+                if (next < fileSize)
+                {
+                    lineStart(next);
+                }
+            }
+            position += static_cast<uint64_t>(bytesRead);
+        }
+        return count;
+    }
+
+public:
+    // Fisierul este impartit in bucati indexate in paralel; intoarce nullptr daca fisierul nu poate fi deschis
+    static shared_ptr<const LineIndex> build(const string& fileName, size_t threadCount = thread::hardware_concurrency())
+    {
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return nullptr;
+        }
+        uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+        size_t chunkCount = static_cast<size_t>(max<uint64_t>(1, min<uint64_t>(max<size_t>(1, threadCount), fileSize / MIN_CHUNK_BYTES)));
+
+        vector<vector<Position>> localCheckpoints(chunkCount);
+        vector<uint64_t> localCounts(chunkCount, 0);
+        auto indexPart = [&](size_t c)
+        {
+            localCounts[c] = indexChunk(fd, fileSize * c / chunkCount, fileSize * (c + 1) / chunkCount, fileSize, localCheckpoints[c]);
+        };
+        vector<thread> workers;
+        for (size_t c = 1; c < chunkCount; ++c)
+        {
+            workers.emplace_back(indexPart, c);
+        }
+        indexPart(0);
+        for (thread& worker : workers)
+        {
+            worker.join();
+        }
+        ::close(fd);
+        fileIoBytes += fileSize;
+
+        shared_ptr<LineIndex> index = make_shared<LineIndex>();
+        for (size_t c = 0; c < chunkCount; ++c)
+        {
+            for (const Position& checkpoint : localCheckpoints[c])
+            {
+                index->checkpoints.push_back(Position{index->lineCount + checkpoint.line, checkpoint.offset});
+            }
+            index->lineCount += localCounts[c];
+        }
+        return index;
+    }
+
+    uint64_t getLineCount() const
+    {
+        return lineCount;
+    }
+
+    // Ultimul reper de la sau dinaintea randului dat (de la 0)
+    Position locate(uint64_t line) const
+    {
+        vector<Position>::const_iterator after = upper_bound(checkpoints.begin(), checkpoints.end(), line,
+            [](uint64_t value, const Position& checkpoint)
+            {
+                return value < checkpoint.line;
+            });
+        return after == checkpoints.begin() ? Position{0, 0} : *(after - 1);
+    }
+};
+
+// Indexurile de randuri, refolosite cat timp fisierul are aceeasi dimensiune si aceeasi data a modificarii
+class LineIndexCache
+{
+private:
+    struct Entry
+    {
+        long long size;
+        long long modified;
+        shared_ptr<const LineIndex> index;
+    };
+
+    static const size_t MAX_ENTRIES = 64;
+
+    mutex cacheMutex;
+    unordered_map<string, Entry> entries;
+
+public:
+    shared_ptr<const LineIndex> get(const string& fileName)
+    {
+        struct stat info;
+        if (stat(fileName.c_str(), &info) != 0)
+        {
+            return nullptr;
+        }
+        long long modified = static_cast<long long>(info.st_mtim.tv_sec) * 1000000000LL + info.st_mtim.tv_nsec;
+        {
+            lock_guard<mutex> guard(cacheMutex);
+            auto found = entries.find(fileName);
+            if (found != entries.end() && found->second.size == info.st_size && found->second.modified == modified)
+            {
+                return found->second.index;
+            }
+        }
+
+        // Indexarea nu tine blocat cache-ul; doua cereri simultane pentru acelasi fisier il pot indexa de doua ori
+        shared_ptr<const LineIndex> index = LineIndex::build(fileName);
+        if (index)
+        {
+            lock_guard<mutex> guard(cacheMutex);
+            if (entries.size() >= MAX_ENTRIES && entries.find(fileName) == entries.end())
+            {
+                entries.erase(entries.begin());
+            }
+            entries[fileName] = Entry{static_cast<long long>(info.st_size), modified, index};
+        }
+        return index;
+    }
+};
+
+LineIndexCache lineIndexCache;
+
+
+// Destinatia fisierelor scrise de OutputStep. Implementarile sunt apelate din mai multe thread-uri
+// (testele de incarcare, serverul), deci scrierile sunt serializate. Bufferele sunt golite periodic si la
+// finalul fiecarei rulari, care raporteaza erorile de scriere amanate.
+class OutputStore
+{
+private:
+    mutex storeMutex;
+    chrono::steady_clock::time_point lastFlush = chrono::steady_clock::now();
+
+protected:
+    chrono::milliseconds flushInterval{1000};
+
+    virtual void writeLocked(const string& fileName, const string& content) = 0;
+    virtual void flushLocked() = 0;
+
+public:
+    virtual ~OutputStore() {}
+
+    void store(const string& fileName, const string& content)
+    {
+        lock_guard<mutex> guard(storeMutex);
+        writeLocked(fileName, content);
+        fileIoBytes += content.size();
+        if (chrono::steady_clock::now() - lastFlush >= flushInterval)
+        {
+            flushLocked();
+            lastFlush = chrono::steady_clock::now();
+        }
+    }
+
+    void flush()
+    {
+        lock_guard<mutex> guard(storeMutex);
+        flushLocked();
+        lastFlush = chrono::steady_clock::now();
+    }
+};
+
+// Comportamentul initial: fiecare fisier este deschis, scris si inchis imediat
+class DirectOutputStore : public OutputStore
+{
+protected:
+    void writeLocked(const string& fileName, const string& content) override
+    {
+        ofstream fileStream(fileName, ios::binary | ios::trunc);
+        if (!fileStream.is_open() || !fileStream.write(content.data(), content.size()))
+        {
+            throw runtime_error("Fisierul " + fileName + " nu a putut fi scris.");
+        }
+    }
+
+    void flushLocked() override {}
+};
+
+// Destinatia rularilor sintetice (teste de incarcare): continutul este numarat, dar nu ajunge pe disc
+class DiscardOutputStore : public OutputStore
+{
+protected:
+    void writeLocked(const string&, const string&) override {}
+    void flushLocked() override {}
+};
+
+// Toate fisierele sunt adaugate ca inregistrari "FILE <lungime> <nume>\n<continut>" in segmente
+// <prefix>.000001.seg, <prefix>.000002.seg, ...; un segment nou incepe cand cel curent depaseste limita
+class SegmentedOutputStore : public OutputStore
+{
+private:
+    string prefix;
+    uint64_t segmentLimit;
+    unsigned segmentNumber;
+    uint64_t segmentSize;
+    unique_ptr<OutputSink> segment;
+
+    string segmentPath() const
+    {
+        char number[16];
+        snprintf(number, sizeof(number), "%06u", segmentNumber);
+        return prefix + "." + number + ".seg";
+    }
+
+    // Continua ultimul segment care mai are loc, ca rularile succesive sa nu suprascrie segmentele vechi
+    void openSegment()
+    {
+        long long existing;
+        while ((existing = fileSizeOf(segmentPath())) >= 0 && static_cast<uint64_t>(existing) >= segmentLimit)
+        {
+            segmentNumber++;
+        }
+        segmentSize = existing > 0 ? static_cast<uint64_t>(existing) : 0;
+        segment.reset(FdSink::openFile(segmentPath(), FdSink::DEFAULT_BUFFER_SIZE, true));
+    }
+
+protected:
+    void writeLocked(const string& fileName, const string& content) override
+    {
+        if (segmentSize >= segmentLimit)
+        {
+            segment.reset();
+            segmentNumber++;
+            openSegment();
+        }
+        string header = "FILE " + to_string(content.size()) + " " + fileName + "\n";
+        segment->write(header);
+        segment->write(content);
+        segmentSize += header.size() + content.size();
+    }
+
+    void flushLocked() override
+    {
+        segment->flush();
+    }
+
+public:
+    SegmentedOutputStore(const string& path, uint64_t limit)
+        : prefix(path), segmentLimit(max<uint64_t>(1, limit)), segmentNumber(1), segmentSize(0)
+    {
+        openSegment();
+    }
+
+    ~SegmentedOutputStore()
+    {
+        try
+        {
+            flush();
+        }
+        catch (const exception&) {}
+    }
+};
+
+// Arhiva tar (ustar) cu cate o intrare per fisier scris; fiecare pornire a aplicatiei adauga intrarile ei
+// dupa cele existente, iar la distrugere arhiva este inchisa corect (doua blocuri goale)
+class ArchiveOutputStore : public OutputStore
+{
+private:
+    static const size_t BLOCK_SIZE = 512;
+    unique_ptr<OutputSink> archive;
+
+    static void writeOctal(char* field, size_t width, uint64_t value)
+    {
+        snprintf(field, width, "%0*llo", static_cast<int>(width - 1), static_cast<unsigned long long>(value));
+    }
+
+    // Sfarsitul ultimei intrari complete dintr-o arhiva existenta (-1 daca fisierul nu exista). Blocurile goale
+    // de final si o intrare scrisa pe jumatate raman dupa el si sunt inlocuite de intrarile noi.
+    static off_t completeEntriesEnd(const string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return -1;
+        }
+        struct stat info;
+        off_t size = fstat(fd, &info) == 0 ? info.st_size : 0;
+        off_t position = 0;
+        char header[BLOCK_SIZE];
+        while (position + static_cast<off_t>(BLOCK_SIZE) <= size
+               && pread(fd, header, BLOCK_SIZE, position) == static_cast<ssize_t>(BLOCK_SIZE))
+        {
+            if (all_of(header, header + BLOCK_SIZE, [](char c) { return c == 0; }))
+            {
+                break;
+            }
+            if (memcmp(header + 257, "ustar", 5) != 0)
+            {
+                ::close(fd);
+                throw runtime_error("Fisierul " + path + " nu este o arhiva tar si nu a fost modificat.");
+            }
+            uint64_t contentSize = strtoull(string(header + 124, 12).c_str(), nullptr, 8);
+            off_t next = position + static_cast<off_t>(BLOCK_SIZE + (contentSize + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE);
+            if (next > size)
+            {
+                break;
+            }
+            position = next;
+        }
+        ::close(fd);
+        return position;
+    }
+
+protected:
+    void writeLocked(const string& fileName, const string& content) override
+    {
+        if (fileName.empty() || fileName.size() > 100)
+        {
+            throw runtime_error("Numele fisierului " + fileName + " nu poate fi pastrat in arhiva.");
+        }
+
+        char header[BLOCK_SIZE] = {};
+        memcpy(header, fileName.data(), fileName.size());
+        writeOctal(header + 100, 8, 0644);
+        writeOctal(header + 108, 8, 0);
+        writeOctal(header + 116, 8, 0);
+        writeOctal(header + 124, 12, content.size());
+        writeOctal(header + 136, 12, static_cast<uint64_t>(time(nullptr)));
+        header[156] = '0';
+        memcpy(header + 257, "ustar", 6);
+        memcpy(header + 263, "00", 2);
+
+        // Suma de control se calculeaza cu campul ei completat cu spatii
+        memset(header + 148, ' ', 8);
+        unsigned checksum = 0;
+        for (size_t i = 0; i < BLOCK_SIZE; ++i)
+        {
+            checksum += static_cast<unsigned char>(header[i]);
+        }
+        snprintf(header + 148, 8, "%06o", checksum);
+        header[155] = ' ';
+
+        archive->write(header, BLOCK_SIZE);
+        archive->write(content);
+        static const char padding[BLOCK_SIZE] = {};
+        archive->write(padding, (BLOCK_SIZE - content.size() % BLOCK_SIZE) % BLOCK_SIZE);
+    }
+
+    void flushLocked() override
+    {
+        archive->flush();
+    }
+
+public:
+    ArchiveOutputStore(const string& path)
+    {
+        off_t end = completeEntriesEnd(path);
+        if (end >= 0 && ::truncate(path.c_str(), end) != 0)
+        {
+            throw runtime_error("Eroare la deschiderea fisierului " + path);
+        }
+        archive.reset(FdSink::openFile(path, FdSink::DEFAULT_BUFFER_SIZE, true));
+    }
+
+    ~ArchiveOutputStore()
+    {
+        try
+        {
+            static const char endOfArchive[2 * BLOCK_SIZE] = {};
+            archive->write(endOfArchive, sizeof(endOfArchive));
+            flush();
+        }
+        catch (const exception&) {}
+    }
+};
+
+// Fisiere normale, dar descriptorii raman deschisi intr-un pool LRU si continutul este scris la flush.
+// Scrierile repetate ale aceluiasi fisier intre doua flush-uri se reduc la una singura.
+class PooledOutputStore : public OutputStore
+{
+private:
+    struct Handle
+    {
+        int fd;
+        string pending;
+        bool dirty;
+        list<string>::iterator recency;
+    };
+
+    size_t capacity;
+    size_t pendingBytes;
+    unordered_map<string, Handle> handles;
+    list<string> recencyOrder;  // Cel mai recent folosit la inceput
+
+    static const size_t PENDING_LIMIT = 4 << 20;
+
+    static void writeHandle(const string& fileName, Handle& handle)
+    {
+        if (!handle.dirty)
+        {
+            return;
+        }
+        if (ftruncate(handle.fd, 0) != 0)
+        {
+            throw runtime_error("Fisierul " + fileName + " nu a putut fi scris.");
+        }
+        size_t offset = 0;
+        while (offset < handle.pending.size())
+        {
+            ssize_t written = pwrite(handle.fd, handle.pending.data() + offset, handle.pending.size() - offset, static_cast<off_t>(offset));
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written < 0)
+            {
+                throw runtime_error("Fisierul " + fileName + " nu a putut fi scris.");
+            }
+            offset += static_cast<size_t>(written);
+        }
+        handle.dirty = false;
+    }
+
+    void evictLeastRecent()
+    {
+        string fileName = recencyOrder.back();
+        Handle& handle = handles[fileName];
+        writeHandle(fileName, handle);
+        pendingBytes -= handle.pending.size();
+        ::close(handle.fd);
+        handles.erase(fileName);
+        recencyOrder.pop_back();
+    }
+
+protected:
+    void writeLocked(const string& fileName, const string& content) override
+    {
+        auto found = handles.find(fileName);
+        if (found == handles.end())
+        {
+            if (handles.size() >= capacity)
+            {
+                evictLeastRecent();
+            }
+            int fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT, 0644);
+            if (fd < 0)
+            {
+                throw runtime_error("Fisierul " + fileName + " nu a putut fi deschis.");
+            }
+            recencyOrder.push_front(fileName);
+            found = handles.emplace(fileName, Handle{fd, "", false, recencyOrder.begin()}).first;
+        }
+        else
+        {
+            recencyOrder.splice(recencyOrder.begin(), recencyOrder, found->second.recency);
+        }
+
+        Handle& handle = found->second;
+        pendingBytes = pendingBytes - handle.pending.size() + content.size();
+        handle.pending = content;
+        handle.dirty = true;
+        if (pendingBytes > PENDING_LIMIT)
+        {
+            flushLocked();
+        }
+    }
+
+    void flushLocked() override
+    {
+        for (auto& entry : handles)
+        {
+            writeHandle(entry.first, entry.second);
+            pendingBytes -= entry.second.pending.size();
+            entry.second.pending.clear();
+        }
+    }
+
+public:
+    PooledOutputStore(size_t handleCount) : capacity(max<size_t>(1, handleCount)), pendingBytes(0) {}
+
+    ~PooledOutputStore()
+    {
+        try
+        {
+            flush();
+        }
+        catch (const exception&) {}
+        for (auto& entry : handles)
+        {
+            ::close(entry.second.fd);
+        }
+    }
+};
+
+// Formatul optiunii --output-store: direct, segment:<prefix>[:<MiB>], archive:<fisier.tar>, pool:<descriptori>
+// Marimile din specificatie sunt numere intregi pozitive, fara alte caractere
+uint64_t parseStoreSize(const string& text, const string& spec, uint64_t maximum)
+{
+    uint64_t value = 0;
+    from_chars_result parsed = from_chars(text.data(), text.data() + text.size(), value);
+    if (parsed.ec != errc() || parsed.ptr != text.data() + text.size() || value == 0 || value > maximum)
+    {
+        throw runtime_error("Destinatie de iesire invalida: " + spec);
+    }
+    return value;
+}
+
+OutputStore* createOutputStore(const string& spec)
+{
+    string mode = spec.substr(0, spec.find(':'));
+    string argument = spec.find(':') == string::npos ? "" : spec.substr(spec.find(':') + 1);
+    if (mode == "direct")
+    {
+        return new DirectOutputStore();
+    }
+    if (mode == "segment" && !argument.empty())
+    {
+        size_t separator = argument.rfind(':');
+        uint64_t megabytes = 64;
+        if (separator != string::npos)
+        {
+            megabytes = parseStoreSize(argument.substr(separator + 1), spec, numeric_limits<uint64_t>::max() >> 20);
+            argument.erase(separator);
+        }
+        return new SegmentedOutputStore(argument, megabytes << 20);
+    }
+    if (mode == "archive" && !argument.empty())
+    {
+        return new ArchiveOutputStore(argument);
+    }
+    if (mode == "pool" && !argument.empty())
+    {
+        return new PooledOutputStore(static_cast<size_t>(parseStoreSize(argument, spec, numeric_limits<size_t>::max())));
+    }
+    throw runtime_error("Destinatie de iesire invalida: " + spec);
+}
+
+unique_ptr<OutputStore> outputFileStore(new DirectOutputStore());
+thread_local OutputStore* threadFileStore = nullptr;
+
+OutputStore& fileStore()
+{
+    return threadFileStore ? *threadFileStore : *outputFileStore;
+}
+
+// Redirectioneaza afisarea si fisierele pasilor pe thread-ul curent cat timp exista obiectul
+class OutputScope
+{
+private:
+    OutputSink* previousSink;
+    OutputStore* previousStore;
+
+public:
+    OutputScope(OutputSink& sink, OutputStore& store) : previousSink(threadOutputSink), previousStore(threadFileStore)
+    {
+        threadOutputSink = &sink;
+        threadFileStore = &store;
+    }
+
+    ~OutputScope()
+    {
+        threadOutputSink = previousSink;
+        threadFileStore = previousStore;
+    }
+
+    OutputScope(const OutputScope&) = delete;
+    OutputScope& operator=(const OutputScope&) = delete;
+};
+
+
+// Intrarea si prompturile pasilor; implicit consola, redirectionate pe thread la inregistrare si la rejucare
+thread_local istream* stepInputStream = &cin;
+thread_local ostream* stepPromptStream = &cout;
+
+istream& stepInput()
+{
+    return *stepInputStream;
+}
+
+ostream& stepPrompt()
+{
+    return *stepPromptStream;
+}
+
+// Redirectioneaza intrarea si prompturile pasilor pe thread-ul curent cat timp exista obiectul
+class StepIOScope
+{
+private:
+    istream* previousInput;
+    ostream* previousPrompt;
+
+public:
+    StepIOScope(istream& input, ostream& prompt) : previousInput(stepInputStream), previousPrompt(stepPromptStream)
+    {
+        stepInputStream = &input;
+        stepPromptStream = &prompt;
+    }
+
+    ~StepIOScope()
+    {
+        stepInputStream = previousInput;
+        stepPromptStream = previousPrompt;
+    }
+
+    StepIOScope(const StepIOScope&) = delete;
+    StepIOScope& operator=(const StepIOScope&) = delete;
+};
+
+// Citeste din alt streambuf si pastreaza exact caracterele consumate (nu si pe cele doar privite)
+class RecordingStreamBuf : public streambuf
+{
+private:
+    streambuf* source;
+    string recorded;
+
+protected:
+    int_type underflow() override
+    {
+        return source->sgetc();
+    }
+
+    int_type uflow() override
+    {
+        int_type c = source->sbumpc();
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            recorded.push_back(traits_type::to_char_type(c));
+        }
+        return c;
+    }
+
+public:
+    RecordingStreamBuf(streambuf* src) : source(src) {}
+
+    const string& getRecorded() const
+    {
+        return recorded;
+    }
+};
+
+// O rulare inregistrata: intrarea consumata de pasi, rezultatul si durata
+struct RunTrace
+{
+    string flowName;
+    string input;
+    uint64_t durationMicros;
+    bool completed;
+};
+
+// Fisier binar de urme: magic, apoi cate o inregistrare prefixata cu lungimea, adaugata la fiecare rulare
+class TraceLog
+{
+private:
+    string path;
+    mutex logMutex;
+
+public:
+    static const uint32_t TRACE_MAGIC = 0x31525446;  // "FTR1"
+
+    // O inregistrare scrisa pe jumatate (o oprire in timpul unui append) este taiata, ca urmele adaugate de acum
+    // sa nu ajunga dupa ea, unde nu ar mai putea fi citite
+    TraceLog(const string& p) : path(p)
+    {
+        ifstream traceFile(path, ios::binary);
+        if (!traceFile.is_open())
+        {
+            return;
+        }
+        string data((istreambuf_iterator<char>(traceFile)), istreambuf_iterator<char>());
+        traceFile.close();
+        size_t complete = data.size();
+        try
+        {
+            vector<RunTrace> traces;
+            complete = readRecords(data, traces);
+        }
+        catch (const runtime_error&)
+        {
+            // Un fisier strain sau corupt nu este modificat; doar un antet taiat inseamna ca nu exista nicio urma
+            if (data.size() < 4)
+            {
+                complete = 0;
+            }
+        }
+        if (complete < data.size() && ::truncate(path.c_str(), static_cast<off_t>(complete)) != 0)
+        {
+            cerr << "Eroare la repararea fisierului de urme " << path << "\n";
+        }
+    }
+
+    void append(const RunTrace& trace)
+    {
+        BinaryWriter record;
+        record.writeString(trace.flowName);
+        record.writeString(trace.input);
+        record.writeVarint(trace.durationMicros);
+        record.writeBool(trace.completed);
+
+        BinaryWriter writer;
+        lock_guard<mutex> guard(logMutex);
+        if (fileSizeOf(path) <= 0)
+        {
+            writer.writeU32(TRACE_MAGIC);
+        }
+        writer.writeString(record.buffer());
+
+        ofstream traceFile(path, ios::binary | ios::app);
+        if (!traceFile.is_open())
+        {
+            cerr << "Eroare la scrierea urmei in " << path << "\n";
+            return;
+        }
+        traceFile.write(writer.buffer().data(), writer.buffer().size());
+    }
+
+    static vector<RunTrace> load(const string& path)
+    {
+        ifstream traceFile(path, ios::binary);
+        if (!traceFile.is_open())
+        {
+            throw runtime_error("Eroare la deschiderea fisierului de urme " + path);
+        }
+        string data((istreambuf_iterator<char>(traceFile)), istreambuf_iterator<char>());
+
+        vector<RunTrace> traces;
+        try
+        {
+            readRecords(data, traces);
+        }
+        catch (const runtime_error&)
+        {
+            throw runtime_error("Fisierul " + path + " nu contine urme de rulare.");
+        }
+        return traces;
+    }
+
+    // Citeste inregistrarile intregi si intoarce lungimea lor (cu antet). O inregistrare taiata la final, ca dupa
+    // un crash in timpul unui append, este ignorata; un antet gresit sau o inregistrare intreaga invalida arunca.
+    static size_t readRecords(const string& data, vector<RunTrace>& traces)
+    {
+        BinaryReader reader(data);
+        if (reader.readU32() != TRACE_MAGIC)
+        {
+            throw runtime_error("Antet de urme invalid.");
+        }
+        size_t complete = reader.getPosition();
+        while (!reader.atEnd())
+        {
+            string recordData;
+            try
+            {
+                recordData = reader.readString();
+            }
+            catch (const runtime_error&)
+            {
+                break;
+            }
+            BinaryReader record(recordData);
+            RunTrace trace;
+            trace.flowName = record.readString();
+            trace.input = record.readString();
+            trace.durationMicros = record.readVarint();
+            trace.completed = record.readBool();
+            traces.push_back(move(trace));
+            complete = reader.getPosition();
+        }
+        return complete;
+    }
+};
+
+unique_ptr<TraceLog> traceLog;  // Activat cu --record <fisier>
+
+
+// Cronologia executiei pasilor: evenimente de inceput si de sfarsit, exportate in formatul JSON Chrome trace
+// (deschis de chrome://tracing si de Perfetto). Fiecare thread scrie fara blocari in propriul buffer, format din
+// blocuri care sunt doar adaugate; numarul de evenimente al unui bloc este publicat dupa scrierea evenimentului,
+// asa ca exportul poate citi bufferele in timp ce rularile continua.
+class ExecutionTracer
+{
+private:
+    // Evenimente de dimensiune fixa: numele procesului si tipul pasului sunt id-uri in tabela de nume
+    struct TraceEvent
+    {
+        char phase;  // B/E pentru rularile din consola si server, b/e (asincron, dupa id) pentru rularile suspendabile
+        uint32_t flowId;
+        uint32_t typeId;
+        uint32_t stepIndex;
+        long long timestampMicros;
+        uint64_t ioBytes;  // Doar la sfarsit: octetii de fisier cititi sau scrisi de pas
+        uint64_t asyncId;
+    };
+
+    static const size_t CHUNK_EVENTS = 1024;
+    static const size_t MAX_CHUNKS = 256;  // Peste limita, un thread isi refoloseste cel mai vechi bloc (inel)
+
+    struct Chunk
+    {
+        array<TraceEvent, CHUNK_EVENTS> events;
+        atomic<size_t> count{0};
+        atomic<Chunk*> next{nullptr};
+    };
+
+    struct ThreadBuffer
+    {
+        uint32_t threadId;
+        Chunk* head = nullptr;  // Schimbat doar sub registryMutex; nullptr pana la primul eveniment
+        Chunk* tail = nullptr;  // Folosit de thread-ul care scrie; dupa terminarea lui, doar sub registryMutex
+        size_t chunks = 0;  // Schimbat doar sub registryMutex
+        uint64_t droppedEvents = 0;  // Evenimentele pierdute prin refolosirea blocurilor vechi (sub registryMutex)
+        unordered_map<string_view, uint32_t> nameCache;  // Doar pentru thread-ul care scrie; cheile sunt in names
+        atomic<bool> finished{false};  // Thread-ul s-a terminat (sau scrie in alt tracer); blocurile lui sunt libere
+    };
+
+    // Bufferul thread-ului curent; la iesirea thread-ului il marcheaza terminat. Este tinut si de tracer (shared_ptr),
+    // deci marcarea este sigura chiar daca tracer-ul a fost distrus inaintea thread-ului.
+    struct LocalBuffer
+    {
+        shared_ptr<ThreadBuffer> buffer;
+        uint64_t tracerId = 0;
+
+        void release()
+        {
+            if (buffer)
+            {
+                buffer->finished.store(true, memory_order_release);
+            }
+        }
+
+        ~LocalBuffer()
+        {
+            release();
+        }
+    };
+
+    static atomic<uint64_t> nextTracerId;
+    uint64_t tracerId;  // Identifica tracer-ul in bufferele thread-urilor; adresa poate fi refolosita de un tracer nou
+    chrono::steady_clock::time_point origin;
+    mutable mutex registryMutex;  // Inregistrarea thread-urilor, schimbarea blocurilor si exportul
+    vector<shared_ptr<ThreadBuffer>> buffers;
+    size_t chunkCount = 0;
+    uint32_t nextThreadId = 1;
+    uint64_t retiredDroppedEvents = 0;  // Evenimentele pierdute ale thread-urilor terminate si scoase din lista
+    atomic<uint64_t> nextAsyncId{1};
+
+    mutable shared_mutex namesMutex;
+    deque<string> names;  // Adrese stabile, deci cheile din nameIds si din cache-urile thread-urilor pot fi string_view
+    unordered_map<string_view, uint32_t> nameIds;
+    size_t nameBytes = 0;
+    atomic<size_t> nameCacheBytes{0};
+
+    // Id-ul unui nume: intai din cache-ul thread-ului, fara lock; doar un nume nou pentru thread trece prin tabela comuna
+    uint32_t nameId(ThreadBuffer& buffer, const string& name)
+    {
+        auto cached = buffer.nameCache.find(string_view(name));
+        if (cached != buffer.nameCache.end())
+        {
+            return cached->second;
+        }
+        uint32_t id;
+        string_view key;
+        {
+            unique_lock<shared_mutex> guard(namesMutex);
+            auto found = nameIds.find(name);
+            if (found == nameIds.end())
+            {
+                names.push_back(name);
+                nameBytes += sizeof(string) + name.capacity() + 1 + 4 * sizeof(void*);  // Sirul, cheia si nodul din nameIds
+                found = nameIds.emplace(names.back(), static_cast<uint32_t>(names.size() - 1)).first;
+            }
+            id = found->second;
+            key = found->first;
+        }
+        buffer.nameCache.emplace(key, id);
+        nameCacheBytes += 4 * sizeof(void*);
+        return id;
+    }
+
+    // Bufferul unui thread terminat care si-a cedat toate blocurile nu mai are nimic de exportat
+    void retireEmptyBuffers()
+    {
+        for (size_t i = 0; i < buffers.size();)
+        {
+            ThreadBuffer& other = *buffers[i];
+            if (other.chunks == 0 && other.finished.load(memory_order_acquire))
+            {
+                retiredDroppedEvents += other.droppedEvents;
+                nameCacheBytes -= other.nameCache.size() * 4 * sizeof(void*);
+                buffers.erase(buffers.begin() + static_cast<ptrdiff_t>(i));
+                continue;
+            }
+            ++i;
+        }
+    }
+
+    // Blocul urmator al thread-ului. Sub MAX_CHUNKS blocuri in total se aloca unul nou. Altfel blocul este luat,
+    // in ordine: de la un thread terminat, de la thread-ul cu cele mai multe blocuri (de preferinta cel curent),
+    // sau este reluat singurul bloc al thread-ului; se ia mereu cel mai vechi bloc. Exportul citeste listele sub
+    // acelasi lock, deci nu vede niciodata un bloc pe jumatate refolosit. Intoarce nullptr (evenimentul este
+    // pierdut) daca niciun bloc nu poate fi luat.
+    Chunk* nextChunk(ThreadBuffer& buffer)
+    {
+        lock_guard<mutex> guard(registryMutex);
+        Chunk* chunk;
+        if (chunkCount < MAX_CHUNKS)
+        {
+            chunk = new Chunk();
+            chunkCount++;
+        }
+        else
+        {
+            ThreadBuffer* owner = nullptr;
+            for (const shared_ptr<ThreadBuffer>& other : buffers)
+            {
+                if (other->chunks > 0 && other->finished.load(memory_order_acquire))
+                {
+                    owner = other.get();
+                    break;
+                }
+            }
+            if (!owner)
+            {
+                owner = &buffer;
+                for (const shared_ptr<ThreadBuffer>& other : buffers)
+                {
+                    if (other->chunks > owner->chunks)
+                    {
+                        owner = other.get();
+                    }
+                }
+                if (owner->chunks < 2)
+                {
+                    if (buffer.chunks == 0)
+                    {
+                        buffer.droppedEvents++;
+                        return nullptr;
+                    }
+                    // Singurul bloc al thread-ului este reluat de la inceput
+                    buffer.droppedEvents += buffer.head->count.load(memory_order_relaxed);
+                    buffer.head->count.store(0, memory_order_relaxed);
+                    return buffer.head;
+                }
+            }
+
+            // Thread-ul proprietar scrie doar in coada; capul este coada numai la un thread terminat
+            chunk = owner->head;
+            owner->droppedEvents += chunk->count.load(memory_order_relaxed);
+            owner->head = chunk->next.load(memory_order_relaxed);
+            if (!owner->head)
+            {
+                owner->tail = nullptr;
+            }
+            owner->chunks--;
+            chunk->count.store(0, memory_order_relaxed);
+            chunk->next.store(nullptr, memory_order_relaxed);
+            retireEmptyBuffers();
+        }
+        if (buffer.tail)
+        {
+            buffer.tail->next.store(chunk, memory_order_release);
+        }
+        else
+        {
+            buffer.head = chunk;
+        }
+        buffer.tail = chunk;
+        buffer.chunks++;
+        return chunk;
+    }
+
+    static thread_local LocalBuffer localBuffer;
+
+    ThreadBuffer& threadBuffer()
+    {
+        if (localBuffer.tracerId != tracerId)
+        {
+            // Bufferul pentru un tracer anterior este cedat; primul bloc este luat de nextChunk, in limita MAX_CHUNKS
+            localBuffer.release();
+            shared_ptr<ThreadBuffer> buffer = make_shared<ThreadBuffer>();
+            lock_guard<mutex> guard(registryMutex);
+            buffer->threadId = nextThreadId++;
+            buffers.push_back(buffer);
+            localBuffer.buffer = buffer;
+            localBuffer.tracerId = tracerId;
+        }
+        return *localBuffer.buffer;
+    }
+
+    void record(char phase, const string& flowName, size_t stepIndex, const string& stepType, uint64_t ioBytes, uint64_t asyncId)
+    {
+        long long timestamp = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - origin).count();
+        ThreadBuffer& buffer = threadBuffer();
+        Chunk* chunk = buffer.tail;
+        size_t count = chunk ? chunk->count.load(memory_order_relaxed) : CHUNK_EVENTS;
+        if (count == CHUNK_EVENTS)
+        {
+            chunk = nextChunk(buffer);
+            count = 0;
+            if (!chunk)
+            {
+                return;
+            }
+        }
+        chunk->events[count] = TraceEvent{phase, nameId(buffer, flowName), nameId(buffer, stepType), static_cast<uint32_t>(stepIndex),
+                                          timestamp, ioBytes, asyncId};
+        chunk->count.store(count + 1, memory_order_release);
+    }
+
+    static string jsonString(const string& text)
+    {
+        string quoted = "\"";
+        for (unsigned char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                quoted += '\\';
+                quoted += static_cast<char>(c);
+            }
+            else if (c < 0x20)
+            {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                quoted += escaped;
+            }
+            else
+            {
+                quoted += static_cast<char>(c);
+            }
+        }
+        return quoted + "\"";
+    }
+
+public:
+    ExecutionTracer() : tracerId(nextTracerId++), origin(chrono::steady_clock::now()) {}
+
+    ~ExecutionTracer()
+    {
+        for (const shared_ptr<ThreadBuffer>& buffer : buffers)
+        {
+            Chunk* chunk = buffer->head;
+            while (chunk)
+            {
+                Chunk* next = chunk->next.load(memory_order_acquire);
+                delete chunk;
+                chunk = next;
+            }
+            buffer->head = buffer->tail = nullptr;
+        }
+    }
+
+    ExecutionTracer(const ExecutionTracer&) = delete;
+    ExecutionTracer& operator=(const ExecutionTracer&) = delete;
+
+    // Memoria evenimentelor si a tabelei de nume, raportata de MemoryReport si numarata in bugetul total
+    size_t memoryBytes() const
+    {
+        size_t bytes;
+        {
+            lock_guard<mutex> guard(registryMutex);
+            bytes = chunkCount * sizeof(Chunk) + buffers.size() * sizeof(ThreadBuffer);
+        }
+        shared_lock<shared_mutex> guard(namesMutex);
+        return bytes + nameBytes + nameCacheBytes.load();
+    }
+
+    // Id-ul care leaga inceputul si sfarsitul pasilor unei rulari suspendabile, reluata eventual pe alt thread
+    uint64_t newAsyncId()
+    {
+        return nextAsyncId++;
+    }
+
+    void beginStep(const string& flowName, size_t stepIndex, const string& stepType, uint64_t asyncId = 0)
+    {
+        record(asyncId ? 'b' : 'B', flowName, stepIndex, stepType, 0, asyncId);
+    }
+
+    void endStep(const string& flowName, size_t stepIndex, const string& stepType, uint64_t ioBytes, uint64_t asyncId = 0)
+    {
+        record(asyncId ? 'e' : 'E', flowName, stepIndex, stepType, ioBytes, asyncId);
+    }
+
+    // Evenimentele inregistrate pana acum; intoarce numarul lor sau -1 daca fisierul nu poate fi scris
+    long long exportChromeTrace(const string& path) const
+    {
+        ofstream file(path, ios::trunc);
+        if (!file.is_open())
+        {
+            return -1;
+        }
+        long long exported = 0;
+        const char* separator = "\n";
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        lock_guard<mutex> guard(registryMutex);
+        shared_lock<shared_mutex> namesGuard(namesMutex);
+        if (retiredDroppedEvents > 0)
+        {
+            file << separator << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"flows\",\"droppedEvents\":"
+                 << retiredDroppedEvents << "}}";
+            separator = ",\n";
+        }
+        for (const shared_ptr<ThreadBuffer>& buffer : buffers)
+        {
+            file << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"args\":{\"name\":\"thread " << buffer->threadId << "\",\"droppedEvents\":" << buffer->droppedEvents << "}}";
+            separator = ",\n";
+            for (const Chunk* chunk = buffer->head; chunk; chunk = chunk->next.load(memory_order_acquire))
+            {
+                size_t count = chunk->count.load(memory_order_acquire);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    const TraceEvent& event = chunk->events[i];
+                    file << separator << "{\"name\":" << jsonString(names[event.typeId]) << ",\"cat\":\"step\",\"ph\":\"" << event.phase
+                         << "\",\"ts\":" << event.timestampMicros << ",\"pid\":1,\"tid\":" << buffer->threadId;
+                    if (event.asyncId)
+                    {
+                        file << ",\"id\":" << event.asyncId;
+                    }
+                    file << ",\"args\":{\"flow\":" << jsonString(names[event.flowId]) << ",\"step\":" << event.stepIndex + 1;
+                    if (event.phase == 'E' || event.phase == 'e')
+                    {
+                        file << ",\"ioBytes\":" << event.ioBytes;
+                    }
+                    file << "}}";
+                    exported++;
+                }
+            }
+        }
+        file << "\n]}\n";
+        return file.good() ? exported : -1;
+    }
+};
+
+atomic<uint64_t> ExecutionTracer::nextTracerId{1};
+thread_local ExecutionTracer::LocalBuffer ExecutionTracer::localBuffer;
+
+unique_ptr<ExecutionTracer> executionTracer;  // Activat cu --trace-out <fisier.json>
+
+
+// Corutina unui pas sau a unei rulari suspendabile. Porneste suspendata; cand este asteptata cu co_await
+// dintr-o alta corutina, la final continua direct corutina care o astepta (transfer simetric).
+class StepTask
+{
+public:
+    struct promise_type
+    {
+        coroutine_handle<> continuation;
+        exception_ptr error;
+
+        StepTask get_return_object()
+        {
+            return StepTask(coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            coroutine_handle<> await_suspend(coroutine_handle<promise_type> handle) noexcept
+            {
+                coroutine_handle<> next = handle.promise().continuation;
+                return next ? next : noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception()
+        {
+            error = current_exception();
+        }
+    };
+
+    explicit StepTask(coroutine_handle<promise_type> h) : handle(h) {}
+
+    StepTask(StepTask&& other) noexcept : handle(other.handle)
+    {
+        other.handle = nullptr;
+    }
+
+    StepTask(const StepTask&) = delete;
+    StepTask& operator=(const StepTask&) = delete;
+
+    // Distrugerea unei corutine suspendate elibereaza si corutinele pe care le astepta
+    ~StepTask()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    coroutine_handle<> await_suspend(coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    void await_resume()
+    {
+        if (handle.promise().error)
+        {
+            rethrow_exception(handle.promise().error);
+        }
+    }
+
+    // Porneste corutina de pe nivelul cel mai de sus; revine la prima suspendare
+    void start()
+    {
+        handle.resume();
+    }
+
+    bool isDone() const
+    {
+        return handle.done();
+    }
+
+private:
+    coroutine_handle<promise_type> handle;
+};
+
+// Legatura dintre o rulare suspendabila si persoana care raspunde. Intrebarile si mesajele se aduna
+// in transcript; pasul care asteapta un raspuns ramane parcat pana la answer(), fara sa tina un thread.
+class StepContext
+{
+private:
+    ostringstream transcript;
+    string answerText;
+    coroutine_handle<> waiting;
+
+public:
+    struct AnswerAwaiter
+    {
+        StepContext& context;
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(coroutine_handle<> handle) noexcept
+        {
+            context.waiting = handle;
+        }
+
+        string await_resume()
+        {
+            return move(context.answerText);
+        }
+    };
+
+    ostream& prompt()
+    {
+        return transcript;
+    }
+
+    AnswerAwaiter ask(const string& question)
+    {
+        transcript << question;
+        return AnswerAwaiter{*this};
+    }
+
+    bool isWaiting() const
+    {
+        return static_cast<bool>(waiting);
+    }
+
+    // Reia pasul parcat cu raspunsul primit; revine la urmatoarea intrebare sau la finalul rularii
+    void answer(const string& text)
+    {
+        answerText = text;
+        coroutine_handle<> handle = waiting;
+        waiting = nullptr;
+        handle.resume();
+    }
+
+    string takeTranscript()
+    {
+        string text = transcript.str();
+        transcript.str("");
+        return text;
+    }
+};
+
+
+// Eroare aruncata de un pas care nu a putut fi executat; Flow o inregistreaza si poate reincerca pasul
+class StepError : public runtime_error
+{
+public:
+    StepError(const string& message) : runtime_error(message) {}
+};
+
+// Intrarea pasilor pentru rularile fara consola: orice citire arunca StepError. Exceptia ajunge la pas
+// doar daca stream-ul are badbit in exceptions(), altfel istream o transforma in badbit.
+class ClosedInputBuf : public streambuf
+{
+protected:
+    int_type underflow() override
+    {
+        throw StepError("Pasul cere date de intrare, dar rularea nu are consola; folositi START.");
+    }
+};
+
+
+// Numar zecimal cu virgula fixa: valoarea inmultita cu 10^4 intr-un int64, fara erorile de rotunjire
+// ale float-ului la sume de bani. Rezultatele intermediare ale inmultirii si impartirii folosesc 128 de biti.
+class FixedDecimal
+{
+private:
+    int64_t units;
+
+    // Un rezultat care nu incape in int64 este o eroare a pasului, nu o valoare trunchiata
+    static int64_t checkedUnits(__int128 value)
+    {
+        if (value > numeric_limits<int64_t>::max() || value < numeric_limits<int64_t>::min())
+        {
+            throw StepError("Rezultatul depaseste domeniul numerelor zecimale fixe.");
+        }
+        return static_cast<int64_t>(value);
+    }
+
+    // Impartire rotunjita la cel mai apropiat intreg (jumatatile se rotunjesc departe de zero)
+    static int64_t roundedDivide(__int128 numerator, __int128 denominator)
+    {
+        __int128 quotient = numerator / denominator;
+        __int128 remainder = numerator % denominator;
+        if (2 * (remainder < 0 ? -remainder : remainder) >= (denominator < 0 ? -denominator : denominator))
+        {
+            quotient += ((numerator < 0) != (denominator < 0)) ? -1 : 1;
+        }
+        return checkedUnits(quotient);
+    }
+
+public:
+    static const int DIGITS = 4;
+    static const int64_t SCALE = 10000;
+
+    FixedDecimal() : units(0) {}
+
+    static FixedDecimal fromUnits(int64_t value)
+    {
+        FixedDecimal result;
+        result.units = value;
+        return result;
+    }
+
+    int64_t getUnits() const
+    {
+        return units;
+    }
+
+    double toDouble() const
+    {
+        return static_cast<double>(units) / SCALE;
+    }
+
+    FixedDecimal operator+(const FixedDecimal& other) const
+    {
+        return fromUnits(checkedUnits(static_cast<__int128>(units) + other.units));
+    }
+    FixedDecimal operator-(const FixedDecimal& other) const
+    {
+        return fromUnits(checkedUnits(static_cast<__int128>(units) - other.units));
+    }
+    FixedDecimal operator*(const FixedDecimal& other) const
+    {
+        return fromUnits(roundedDivide(static_cast<__int128>(units) * other.units, SCALE));
+    }
+    FixedDecimal operator/(const FixedDecimal& other) const
+    {
+        return fromUnits(roundedDivide(static_cast<__int128>(units) * SCALE, other.units));
+    }
+
+    bool operator==(const FixedDecimal& other) const { return units == other.units; }
+    bool operator!=(const FixedDecimal& other) const { return units != other.units; }
+    bool operator<(const FixedDecimal& other) const { return units < other.units; }
+
+    // Zerourile de la final sunt omise: 12.5000 se afiseaza 12.5
+    string toString() const
+    {
+        uint64_t magnitude = units < 0 ? 0 - static_cast<uint64_t>(units) : static_cast<uint64_t>(units);
+        string text = (units < 0 ? "-" : "") + to_string(magnitude / SCALE);
+        string fraction = to_string(magnitude % SCALE);
+        fraction = string(DIGITS - fraction.size(), '0') + fraction;
+        fraction.erase(fraction.find_last_not_of('0') + 1);
+        return fraction.empty() ? text : text + "." + fraction;
+    }
+
+    // Citeste exact forma zecimala [-]cifre[.cifre]; zecimalele in plus sunt rotunjite
+    static bool parse(const string& text, FixedDecimal& value)
+    {
+        size_t position = 0;
+        bool negative = false;
+        if (position < text.size() && (text[position] == '-' || text[position] == '+'))
+        {
+            negative = text[position++] == '-';
+        }
+
+        __int128 magnitude = 0;
+        size_t digits = 0;
+        while (position < text.size() && isdigit(static_cast<unsigned char>(text[position])))
+        {
+            magnitude = magnitude * 10 + (text[position++] - '0');
+            digits++;
+            if (magnitude > numeric_limits<int64_t>::max() / SCALE)
+            {
+                return false;
+            }
+        }
+        magnitude *= SCALE;
+
+        if (position < text.size() && text[position] == '.')
+        {
+            position++;
+            int64_t place = SCALE / 10;
+            bool roundUp = false;
+            for (; position < text.size() && isdigit(static_cast<unsigned char>(text[position])); ++position, ++digits)
+            {
+                if (place > 0)
+                {
+                    magnitude += (text[position] - '0') * place;
+                    place /= 10;
+                }
+                else if (place == 0)
+                {
+                    roundUp = text[position] >= '5';
+                    place = -1;
+                }
+            }
+            if (roundUp)
+            {
+                magnitude++;
+            }
+        }
+
+        if (digits == 0 || position != text.size() || magnitude > numeric_limits<int64_t>::max())
+        {
+            return false;
+        }
+        value.units = static_cast<int64_t>(negative ? -magnitude : magnitude);
+        return true;
+    }
+};
+
+istream& operator>>(istream& input, FixedDecimal& value)
+{
+    string token;
+    if (input >> token && !FixedDecimal::parse(token, value))
+    {
+        input.setstate(ios::failbit);
+    }
+    return input;
+}
+
+// Ce difera intre tipurile numerice ale pasilor: numele, afisarea si forma binara (checkpoint si cache)
+template<typename T>
+struct NumericTraits;
+
+template<>
+struct NumericTraits<float>
+{
+    static const char* suffix() { return ""; }
+    static string format(float value) { return formatNumber(value); }
+    static double toDouble(float value) { return value; }
+    static void write(BinaryWriter& writer, float value) { writer.writeNumber(value); }
+    static float read(BinaryReader& reader) { return static_cast<float>(reader.readNumber()); }
+};
+
+template<>
+struct NumericTraits<double>
+{
+    static const char* suffix() { return " (double)"; }
+    static string format(double value) { return formatNumber(value); }
+    static double toDouble(double value) { return value; }
+    static void write(BinaryWriter& writer, double value) { writer.writeNumber(value); }
+    static double read(BinaryReader& reader) { return reader.readNumber(); }
+};
+
+template<>
+struct NumericTraits<FixedDecimal>
+{
+    static const char* suffix() { return " (decimal)"; }
+    static string format(const FixedDecimal& value) { return value.toString(); }
+    static double toDouble(const FixedDecimal& value) { return value.toDouble(); }
+    static void write(BinaryWriter& writer, const FixedDecimal& value) { writer.writeSignedVarint(value.getUnits()); }
+    static FixedDecimal read(BinaryReader& reader) { return FixedDecimal::fromUnits(reader.readSignedVarint()); }
+};
+
+
+// Memoria alocata separat de un sir; sirurile scurte stau in obiect (datele lor sunt in interiorul lui) si nu adauga nimic
+size_t heapBytes(const string& text)
+{
+    const char* object = reinterpret_cast<const char*>(&text);
+    bool inObject = !less<const char*>()(text.data(), object) && less<const char*>()(text.data(), object + sizeof(string));
+    return inObject ? 0 : text.capacity() + 1;
+}
+
+// Clasa de baza abstracta pentru pasi
+class Step
+{
+private:
+    friend class StepPool;
+    bool shared = false;  // Pas comun din StepPool; copiile nu mostenesc marcajul
+
+public:
+    Step() {}
+    Step(const Step&) {}
+    Step& operator=(const Step&) { return *this; }
+
+    virtual void execute() = 0;
+    virtual string getStepType() const = 0;
+    virtual string getDescription() const = 0;
+    virtual void writeDetailsToFile(ostream& file) const = 0;
+    virtual ~Step() {}
+    virtual bool isNumberInputStep() const { return false; }
+
+    // Starea produsa de execute(), salvata in checkpoint-uri pentru reluare
+    virtual void saveState(BinaryWriter&) const {}
+    virtual void loadState(BinaryReader&) {}
+
+    // Pasii deterministi produc acelasi rezultat pentru aceleasi intrari si pot folosi resultCache
+    virtual bool isDeterministic() const { return false; }
+
+    // Rezultatul numeric al pasului, folosit de conditiile de salt; false daca pasul nu are unul
+    virtual bool getNumericResult(double&) const { return false; }
+
+    // Fisierul citit sau scris de pas, folosit de indexul de cautare; gol daca pasul nu foloseste fisiere
+    virtual string getFileName() const { return ""; }
+
+    // Copie independenta a pasului, folosita pentru replicile proceselor din testele de incarcare
+    virtual Step* clone() const = 0;
+    virtual void remapInputs(const unordered_map<const Step*, Step*>&) {}
+
+    // Adauga la input intrarea pe care pasul o consuma la o rulare, pentru urmele sintetice.
+    // Fiecare fragment incepe cu un separator de linie, consumat de ignore() sau sarit de >>.
+    virtual void synthesizeInput(string&, minstd_rand&) const {}
+
+    // Memoria ocupata de pas, cu sirurile si vectorii proprii, pentru bugetele de memorie ale proceselor
+    virtual size_t memoryFootprint() const = 0;
+
+    // Randul din definitia CSV a procesului care recreeaza pasul, fara numele procesului (vezi FlowDefinitionCodec)
+    virtual vector<string> getDefinition() const = 0;
+
+    // Varianta suspendabila a lui execute(): intrebarile asteapta raspunsul prin context, fara thread blocat.
+    // Pasii care nu cer nimic folosesc direct execute().
+    virtual StepTask executeAsync(StepContext&)
+    {
+        execute();
+        co_return;
+    }
+
+    // Pasii fara legaturi catre alti pasi pot fi impartiti intre procese prin StepPool
+    virtual bool isShareable() const { return true; }
+
+    // Un pas comun este imutabil: procesul care il ruleaza isi face intai o copie proprie
+    bool isShared() const
+    {
+        return shared;
+    }
+
+    bool isMemoized() const
+    {
+        return isDeterministic() && resultCache.isEnabled();
+    }
+};
+// Clasa pentru pasul de tip titlu
+class TitleStep : public Step
+{
+private:
+    string title;
+    string subtitle;
+
+public:
+    TitleStep(const string& title, const string& subtitle)
+        : title(title), subtitle(subtitle) {}
+    void execute() override
+    {
+
+        stepPrompt() << "TITLE: ";
+        stepInput().ignore();
+        getline(stepInput(), title);
+
+        stepPrompt() << "SUBTITLE: ";
+        getline(stepInput(), subtitle);
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        title = co_await context.ask("TITLE: ");
+        subtitle = co_await context.ask("SUBTITLE: ");
+    }
+
+
+    std::string getStepType() const override
+    {
+        return "Title Step";
+    }
+
+    std::string getDescription() const override
+    {
+        return title + " - " + subtitle;
+    }
+
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "TITLE Step" << "\n";
+    file << "Title: " << title << "\n";
+    file << "Subtitle: " << subtitle << "\n";
+    file << "\n";
+}
+
+    void saveState(BinaryWriter& writer) const override
+    {
+        writer.writeString(title);
+        writer.writeString(subtitle);
+    }
+
+    void loadState(BinaryReader& reader) override
+    {
+        title = reader.readString();
+        subtitle = reader.readString();
+    }
+
+
+
+    Step* clone() const override
+    {
+        return new TitleStep(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(title) + heapBytes(subtitle);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"title", title, subtitle};
+    }
+
+    void synthesizeInput(string& input, minstd_rand& random) const override
+    {
+        input += "\nTitlu " + to_string(random() % 1000) + "\nSubtitlu\n";
+    }
+};
+
+// Clasa pentru pasul de tip text
+class TextStep : public Step
+{
+private:
+    string title;
+    string text;
+
+public:
+    TextStep(const string& title, const string& text)
+        : title(title), text(text) {}
+
+     void execute() override
+    {
+
+        stepPrompt() << "TITLE: ";
+        stepInput().ignore();
+        getline(stepInput(), title);
+
+        stepPrompt() << "COPY: ";
+        getline(stepInput(), text);
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        title = co_await context.ask("TITLE: ");
+        text = co_await context.ask("COPY: ");
+    }
+
+    std::string getStepType() const override
+    {
+        return "Text Step";
+    }
+
+    std::string getDescription() const override
+    {
+        return title + " - " + text;
+    }
+
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "TEXT Step" << "\n";
+    file << "Title: " << title << "\n";
+    file << "Text: " << text << "\n";
+    file << "\n";
+}
+
+    void saveState(BinaryWriter& writer) const override
+    {
+        writer.writeString(title);
+        writer.writeString(text);
+    }
+
+    void loadState(BinaryReader& reader) override
+    {
+        title = reader.readString();
+        text = reader.readString();
+    }
+
+
+
+    Step* clone() const override
+    {
+        return new TextStep(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(title) + heapBytes(text);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"text", title, text};
+    }
+
+    void synthesizeInput(string& input, minstd_rand& random) const override
+    {
+        input += "\nTitlu " + to_string(random() % 1000) + "\nText\n";
+    }
+};
+
+
+
+
+// Clasa pentru pasul de tip text input
+class TextInputStep : public Step
+{
+private:
+    string description;
+    string textInput;
+
+public:
+    TextInputStep(const string& desc, const string& textInput) : description(desc), textInput(textInput) {}
+
+    void execute() override
+    {
+
+        stepPrompt() << "DESCRIPTION: ";
+        stepInput().ignore();
+        getline(stepInput(), description);
+
+        stepPrompt() << "TEXT INPUT: ";
+        getline(stepInput(), textInput);
+
+
+        if (textInput.empty())
+        {
+            throw runtime_error("Invalid input. Text input cannot be empty.");
+        }
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        description = co_await context.ask("DESCRIPTION: ");
+        textInput = co_await context.ask("TEXT INPUT: ");
+        if (textInput.empty())
+        {
+            throw runtime_error("Invalid input. Text input cannot be empty.");
+        }
+    }
+    std::string getStepType() const override
+    {
+        return "Text Input Step";
+    }
+
+    std::string getDescription() const override
+    {
+        return description + " - " + textInput;
+    }
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "TEXT INPUT Step" << "\n";
+    file << "Description: " << description << "\n";
+    file << "Text Input: " << textInput << "\n";
+    file << "\n";
+}
+
+    void saveState(BinaryWriter& writer) const override
+    {
+        writer.writeString(description);
+        writer.writeString(textInput);
+    }
+
+    void loadState(BinaryReader& reader) override
+    {
+        description = reader.readString();
+        textInput = reader.readString();
+    }
+
+    Step* clone() const override
+    {
+        return new TextInputStep(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(description) + heapBytes(textInput);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"textinput", description, textInput};
+    }
+
+    void synthesizeInput(string& input, minstd_rand& random) const override
+    {
+        input += "\nDescriere\nRaspuns " + to_string(random() % 1000) + "\n";
+    }
+};
+
+
+// Pasul de citire a unui numar, parametrizat dupa tipul numeric ales pentru proces
+template<typename T>
+class NumberInputStepT : public Step
+{
+private:
+    string description;
+    T numberInput;
+    bool executed;
+
+public:
+    NumberInputStepT(const string& desc) : description(desc), numberInput(), executed(false) {}
+
+    T getNumber() const
+    {
+        return numberInput;
+    }
+
+    bool isExecuted() const {
+        return executed;
+    }
+
+    void execute() override {
+        // Implementation for NUMBER INPUT step
+        stepPrompt() << "Introduceti o descriere: " << description << "\n";
+
+        while (true)
+        {
+            stepPrompt() << "Introduceti un numar: ";
+            if (stepInput() >> numberInput)
+            {
+                // Verifica daca input-ul este valid
+                break;
+            }
+            else
+            {
+                if (stepInput().eof())
+                {
+                    throw StepError("Intrarea s-a terminat inainte de un numar valid.");
+                }
+                // Clear errorul de pe intrare si ignora restul input-ului invalid
+                stepInput().clear();
+                stepInput().ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                stepPrompt() << "Input invalid. Va rugam introduceti un numar valid." << "\n";
+            }
+        }
+
+
+        executed = true;
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        context.prompt() << "Introduceti o descriere: " << description << "\n";
+        while (true)
+        {
+            istringstream answer(co_await context.ask("Introduceti un numar: "));
+            if (answer >> numberInput)
+            {
+                break;
+            }
+            context.prompt() << "Input invalid. Va rugam introduceti un numar valid." << "\n";
+        }
+        executed = true;
+    }
+
+    std::string getStepType() const override
+    {
+        return string("Number Input Step") + NumericTraits<T>::suffix();
+    }
+
+    bool getNumericResult(double& value) const override
+    {
+        value = NumericTraits<T>::toDouble(numberInput);
+        return executed;
+    }
+
+    std::string getDescription() const override
+    {
+        return description + " - " + NumericTraits<T>::format(numberInput);
+    }
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "NUMBER INPUT Step" << "\n";
+    file << "Description: " << description << "\n";
+    file << "Number Input: " << NumericTraits<T>::format(numberInput) << "\n";
+    file << "\n";  // Adaugă o linie goală între detalii
+}
+
+    void saveState(BinaryWriter& writer) const override
+    {
+        NumericTraits<T>::write(writer, numberInput);
+        writer.writeBool(executed);
+    }
+
+    void loadState(BinaryReader& reader) override
+    {
+        numberInput = NumericTraits<T>::read(reader);
+        executed = reader.readBool();
+    }
+
+    Step* clone() const override
+    {
+        return new NumberInputStepT<T>(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(description);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"number", description};
+    }
+
+    void synthesizeInput(string& input, minstd_rand& random) const override
+    {
+        input += "\n" + to_string(random() % 1000);
+    }
+};
+
+using NumberInputStep = NumberInputStepT<float>;
+using DoubleNumberInputStep = NumberInputStepT<double>;
+using DecimalNumberInputStep = NumberInputStepT<FixedDecimal>;
+
+
+// Clasa pentru pasul de tip calculus
+
+// Operatiile sunt instantiate pentru fiecare tip numeric, deci nu exista conversii in timpul calculului
+template<typename T>
+class CalculusStepT : public Step
+{
+private:
+    int steps;
+    string operation;
+    vector<NumberInputStepT<T>*> inputSteps;
+    T result;
+
+    static void calculate(T userInput, T userSecondInput, int operationChoice, T& value)
+    {
+        switch (operationChoice)
+        {
+        case 1:
+            value = userInput + userSecondInput;
+            break;
+        case 2:
+            value = userInput - userSecondInput;
+            break;
+        case 3:
+            value = userInput * userSecondInput;
+            break;
+        case 4:
+            // Verificarea împărțirii la zero
+            if (userSecondInput != T())
+            {
+                value = userInput / userSecondInput;
+            }
+            else
+            {
+                throw StepError("Impartirea la zero nu este posibila. Va rugam sa incercati din nou.");
+            }
+            break;
+        case 5:
+            value = min(userInput, userSecondInput);
+            break;
+        case 6:
+            value = max(userInput, userSecondInput);
+            break;
+        default:
+            throw StepError("Operatie necunoscuta.");
+        }
+    }
+
+public:
+   CalculusStepT(int s, const string& op) : steps(s), operation(op), result() {}
+
+
+    void addInputStep(NumberInputStepT<T>* step)
+    {
+        inputSteps.push_back(step);
+    }
+
+    // Verificarea efectuării pasului NumberInputStep
+    void requireExecutedInputs() const
+    {
+        for (const auto& inputStep : inputSteps)
+        {
+            if (!inputStep->isExecuted())
+            {
+                throw StepError("Trebuie executat NumberInputStep înainte de CalculusStep!");
+            }
+        }
+    }
+
+    static void printOperationMenu(ostream& prompt)
+    {
+        prompt << "Alegeti o optiune:\n";
+        prompt << "1. Adunare (+)\n";
+        prompt << "2. Scădere (-)\n";
+        prompt << "3. Înmulțire (*)\n";
+        prompt << "4. Împărțire (/)\n";
+        prompt << "5. Minim (min)\n";
+        prompt << "6. Maxim (max)\n";
+    }
+
+    void execute()
+    {
+        requireExecutedInputs();
+
+        // Extragerea numărului de la pasul NumberInputStep
+        T userInput = inputSteps[0]->getNumber();
+
+        // Solicitarea utilizatorului pentru introducerea unui alt număr
+        stepPrompt() << "Introduceți un număr pentru operații: ";
+        T userSecondInput = T();
+        stepInput() >> userSecondInput;
+
+        // Afisarea meniului de operații
+        printOperationMenu(stepPrompt());
+        stepPrompt() << "Introduceti numarul corespunzator operatiei pe care vreti sa o alegeti: ";
+
+        int operationChoice;
+        stepInput() >> operationChoice;
+        stepInput().ignore();
+
+        // Efectuarea calculelor in functie de operatia aleasa
+        calculate(userInput, userSecondInput, operationChoice, result);
+
+        stepPrompt() << "Rezultat: " << NumericTraits<T>::format(result) << "\n";
+
+        char continueChoice = 'n';
+        stepPrompt() << "Vrei sa efectuezi alte operatii? (d/n): ";
+        stepInput() >> continueChoice;
+
+        if (continueChoice == 'd' || continueChoice == 'D')
+        {
+            execute(); // Reapelarea functiei pentru a efectua alte operatii cu aceleasi numere
+        }
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        requireExecutedInputs();
+        T userInput = inputSteps[0]->getNumber();
+
+        char continueChoice = 'd';
+        while (continueChoice == 'd' || continueChoice == 'D')
+        {
+            T userSecondInput = T();
+            istringstream(co_await context.ask("Introduceți un număr pentru operații: ")) >> userSecondInput;
+
+            printOperationMenu(context.prompt());
+            int operationChoice = 0;
+            istringstream(co_await context.ask("Introduceti numarul corespunzator operatiei pe care vreti sa o alegeti: ")) >> operationChoice;
+
+            calculate(userInput, userSecondInput, operationChoice, result);
+            context.prompt() << "Rezultat: " << NumericTraits<T>::format(result) << "\n";
+
+            string again = co_await context.ask("Vrei sa efectuezi alte operatii? (d/n): ");
+            continueChoice = again.empty() ? 'n' : again[0];
+        }
+    }
+
+    std::string getStepType() const override
+    {
+        return string("Calculus Step") + NumericTraits<T>::suffix();
+    }
+
+    bool getNumericResult(double& value) const override
+    {
+        value = NumericTraits<T>::toDouble(result);
+        return true;
+    }
+
+    std::string getDescription() const override
+    {
+
+        return std::to_string(steps) + " steps - " + operation;
+    }
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "CALCULUS Step" << "\n";
+    file << "Result: " << NumericTraits<T>::format(result) << "\n";
+    file << "\n";
+}
+
+    void saveState(BinaryWriter& writer) const override
+    {
+        NumericTraits<T>::write(writer, result);
+    }
+
+    void loadState(BinaryReader& reader) override
+    {
+        result = NumericTraits<T>::read(reader);
+    }
+
+    Step* clone() const override
+    {
+        return new CalculusStepT<T>(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(operation) + inputSteps.capacity() * sizeof(NumberInputStepT<T>*);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"calculus", to_string(inputSteps.size()), operation};
+    }
+
+    void synthesizeInput(string& input, minstd_rand& random) const override
+    {
+        // Al doilea numar, operatia si raspunsul "n" la intrebarea de continuare
+        input += "\n" + to_string(1 + random() % 100) + "\n" + to_string(1 + random() % 6) + "\nn";
+    }
+
+    // Copia citeste numerele din copiile pasilor de intrare, nu din procesul original
+    // Calculul pastreaza pointeri catre intrarile din procesul lui, deci nu este impartit
+    bool isShareable() const override
+    {
+        return false;
+    }
+
+    void remapInputs(const unordered_map<const Step*, Step*>& copies) override
+    {
+        for (NumberInputStepT<T>*& inputStep : inputSteps)
+        {
+            auto found = copies.find(inputStep);
+            if (found != copies.end())
+            {
+                inputStep = static_cast<NumberInputStepT<T>*>(found->second);
+            }
+        }
+    }
+};
+
+using CalculusStep = CalculusStepT<float>;
+using DoubleCalculusStep = CalculusStepT<double>;
+using DecimalCalculusStep = CalculusStepT<FixedDecimal>;
+
+
+// Clasa pentru pasul de tip TEXT FILE input
+class TextFileInputStep : public Step
+{
+private:
+    std::string description;
+    std::string fileName;
+
+public:
+    TextFileInputStep(const std::string& desc, const std::string& file) : description(desc), fileName(file) {}
+
+    void execute() override
+    {
+        stepPrompt() << "Introduceti o descriere: " << description << "\n";
+        stepPrompt() << "Introduceti numele fisierului .txt: ";
+        stepInput() >> fileName;
+        showContent();
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        context.prompt() << "Introduceti o descriere: " << description << "\n";
+        istringstream(co_await context.ask("Introduceti numele fisierului .txt: ")) >> fileName;
+        showContent();
+    }
+
+    void showContent() const
+    {
+        std::string fileContent;
+        if (readFileCached(fileName, fileContent, isMemoized()))
+        {
+            output().write("Continutul fisierului:\n");
+            output().writeLine(fileContent);
+            output().flush();
+        }
+        else
+        {
+            throw StepError("Fisierul " + fileName + " nu a putut fi deschis.");
+        }
+    }
+
+    std::string getStepType() const override
+    {
+        return "Text File Input Step";
+    }
+
+    std::string getFileName() const override
+    {
+        return fileName;
+    }
+
+    bool isDeterministic() const override
+    {
+        return true;
+    }
+
+    std::string getDescription() const override
+    {
+        return description + " - " + fileName;
+    }
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "TEXT FILE INPUT Step" << "\n";
+    file << "File: " << fileName << "\n";
+    file << "Description: " << description << "\n";
+    file << "\n";
+}
+
+    void saveState(BinaryWriter& writer) const override
+    {
+        writer.writeString(fileName);
+    }
+
+    void loadState(BinaryReader& reader) override
+    {
+        fileName = reader.readString();
+    }
+
+    Step* clone() const override
+    {
+        return new TextFileInputStep(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(description) + heapBytes(fileName);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"textfile", description, fileName};
+    }
+
+    void synthesizeInput(string& input, minstd_rand&) const override
+    {
+        input += "\n" + (fileName.empty() ? string("input.txt") : fileName);
+    }
+};
+
+// Clasa pentru pasul de tip CSV FILE input
+class CSVFileInputStep : public Step
+{
+private:
+    std::string description;
+    std::string fileName;
+
+public:
+    CSVFileInputStep(const std::string& desc, const std::string& file) : description(desc), fileName(file) {}
+
+    void execute() override
+    {
+        stepPrompt() << "Introduceti o descriere: " << description << "\n";
+        stepPrompt() << "Introduceti numele fisierului .csv: ";
+        stepInput() >> fileName;
+        showContent();
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        context.prompt() << "Introduceti o descriere: " << description << "\n";
+        istringstream(co_await context.ask("Introduceti numele fisierului .csv: ")) >> fileName;
+        showContent();
+    }
+
+    void showContent() const
+    {
+        std::string fileContent;
+        if (readFileCached(fileName, fileContent, isMemoized()))
+        {
+            output().write("Continutul fisierului:\n");
+            output().writeLine(fileContent);
+            output().flush();
+        }
+        else
+        {
+            throw StepError("Fisierul " + fileName + " nu a putut fi deschis.");
+        }
+    }
+
+     std::string getStepType() const override
+    {
+        return "CSV File Input Step";
+    }
+
+    std::string getFileName() const override
+    {
+        return fileName;
+    }
+
+    bool isDeterministic() const override
+    {
+        return true;
+    }
+
+    std::string getDescription() const override
+    {
+        return description + " - " + fileName;
+    }
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "CSV FILE INPUT Step" << "\n";
+    file << "File name: " << fileName << "\n";
+    file << "Description: " << description << "\n";
+    file << "\n";
+}
+
+    void saveState(BinaryWriter& writer) const override
+    {
+        writer.writeString(fileName);
+    }
+
+    void loadState(BinaryReader& reader) override
+    {
+        fileName = reader.readString();
+    }
+
+
+    Step* clone() const override
+    {
+        return new CSVFileInputStep(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(description) + heapBytes(fileName);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"csvfile", description, fileName};
+    }
+
+    void synthesizeInput(string& input, minstd_rand&) const override
+    {
+        input += "\n" + (fileName.empty() ? string("input.csv") : fileName);
+    }
+};
+
+// Clasa pentru pasul DISPLAY
+class DisplayStep : public Step
+{
+private:
+    int step;
+    string content;
+    string fileName;
+
+    void displayFile(ifstream& inputFile) const
+    {
+        // Fisierele care incap in cache sunt afisate din memorie la rularile urmatoare
+        long long size = fileSizeOf(fileName);
+        string cachedContent;
+        if (isMemoized() && size >= 0 && static_cast<size_t>(size) <= resultCache.getCapacity()
+            && readFileCached(fileName, cachedContent, true))
+        {
+            output().write(cachedContent);
+            output().flush();
+            return;
+        }
+        streamFileToSink(inputFile, output());
+    }
+
+public:
+    DisplayStep(int s, const string& c, const string& file) : step(s), content(c), fileName(file) {}
+
+
+    void execute()
+    {
+        stepPrompt() << "Executarea pasului DISPLAY pentru TEXT FILE (tastati 1) sau pentru CSV FILE (tastati 2) : " << step << "\n";
+
+        int fileTypeChoice;
+        stepPrompt() << "Selectati tipul fisierului pentru afisare (1 - TEXT FILE, 2 - CSV FILE, 3 - un interval de randuri): ";
+        stepInput() >> fileTypeChoice;
+        if (fileTypeChoice == 3)
+        {
+            size_t firstLine = 0;
+            size_t lineCount = 0;
+            stepPrompt() << "Primul rand: ";
+            stepInput() >> firstLine;
+            stepPrompt() << "Numarul de randuri: ";
+            stepInput() >> lineCount;
+            displayLines(firstLine, lineCount);
+            return;
+        }
+        displayChoice(fileTypeChoice);
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        context.prompt() << "Executarea pasului DISPLAY pentru TEXT FILE (tastati 1) sau pentru CSV FILE (tastati 2) : " << step << "\n";
+        int fileTypeChoice = 0;
+        istringstream(co_await context.ask("Selectati tipul fisierului pentru afisare (1 - TEXT FILE, 2 - CSV FILE, 3 - un interval de randuri): ")) >> fileTypeChoice;
+        if (fileTypeChoice == 3)
+        {
+            size_t firstLine = 0;
+            size_t lineCount = 0;
+            istringstream(co_await context.ask("Primul rand: ")) >> firstLine;
+            istringstream(co_await context.ask("Numarul de randuri: ")) >> lineCount;
+            displayLines(firstLine, lineCount);
+            co_return;
+        }
+        displayChoice(fileTypeChoice);
+    }
+
+    void displayChoice(int fileTypeChoice) const
+    {
+        ifstream inputFile(fileName);
+
+        if (!inputFile)
+        {
+            throw runtime_error("Eroare la deschiderea fisierului " + fileName);
+        }
+
+        if (fileTypeChoice == 1)
+        {
+            // Afișare conținut TEXT FILE
+            displayFile(inputFile);
+        }
+        else if (fileTypeChoice == 2)
+        {
+            // Afișare conținut CSV FILE
+            displayFile(inputFile);
+        }
+        else
+        {
+            throw runtime_error("Selectie invalida a tipului de fisier.");
+        }
+
+        inputFile.close();
+    }
+
+    // Afiseaza lineCount randuri incepand cu randul firstLine (de la 1), pornind de la reperul din indexul de randuri
+    void displayLines(size_t firstLine, size_t lineCount) const
+    {
+        shared_ptr<const LineIndex> index = lineIndexCache.get(fileName);
+        if (!index)
+        {
+            throw runtime_error("Eroare la deschiderea fisierului " + fileName);
+        }
+        if (firstLine == 0 || firstLine > index->getLineCount())
+        {
+            throw runtime_error("Fisierul " + fileName + " are " + to_string(index->getLineCount()) + " randuri.");
+        }
+
+        ifstream inputFile(fileName, ios::binary);
+        if (!inputFile)
+        {
+            throw runtime_error("Eroare la deschiderea fisierului " + fileName);
+        }
+        LineIndex::Position start = index->locate(firstLine - 1);
+        inputFile.seekg(static_cast<streamoff>(start.offset));
+        for (uint64_t line = start.line; line < firstLine - 1; ++line)
+        {
+            inputFile.ignore(numeric_limits<streamsize>::max(), '\n');
+        }
+
+        string line;
+        for (size_t shown = 0; shown < lineCount && getline(inputFile, line); ++shown)
+        {
+            output().writeLine(line);
+        }
+        output().flush();
+        streamoff end = inputFile.eof() ? static_cast<streamoff>(fileSizeOf(fileName)) : static_cast<streamoff>(inputFile.tellg());
+        fileIoBytes += static_cast<uint64_t>(max<streamoff>(0, end - static_cast<streamoff>(start.offset)));
+    }
+     std::string getStepType() const override
+    {
+        return "Display Step";
+    }
+
+    std::string getFileName() const override
+    {
+        return fileName;
+    }
+
+    bool isDeterministic() const override
+    {
+        return true;
+    }
+
+    std::string getDescription() const override
+    {
+        return content + " - " + fileName;
+    }
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "DISPLAY Step" << "\n";
+    file << "file name: " << fileName << "\n";
+    file << "Content: " << content << "\n";
+    file << "\n";  // Adaugă o linie goală între detalii
+}
+
+
+    Step* clone() const override
+    {
+        return new DisplayStep(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(content) + heapBytes(fileName);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"display", to_string(step), content, fileName};
+    }
+
+    void synthesizeInput(string& input, minstd_rand& random) const override
+    {
+        input += "\n" + to_string(1 + random() % 2);
+    }
+};
+
+// Clasa pentru pasul de tip OUTPUT
+class OutputStep : public Step
+{
+private:
+    int stepNumber;
+    std::string fileName;
+    std::string title;
+    std::string description;
+
+public:
+    OutputStep(int step, const std::string& file, const std::string& t, const std::string& desc)
+        : stepNumber(step), fileName(file), title(t), description(desc) {}
+
+    void execute() override
+    {
+        stepPrompt() << "Introduceti numele fisierului de iesire .txt: ";
+        stepInput() >> fileName;
+        writeOutputFile(stepPrompt());
+    }
+
+    StepTask executeAsync(StepContext& context) override
+    {
+        istringstream(co_await context.ask("Introduceti numele fisierului de iesire .txt: ")) >> fileName;
+        writeOutputFile(context.prompt());
+    }
+
+    void writeOutputFile(ostream& prompt) const
+    {
+        // Continutul trece prin destinatia configurata (--output-store), nu printr-un ofstream propriu
+        std::ostringstream fileStream;
+        fileStream << "Title: " << title << "\n";
+        fileStream << "Description: " << description << "\n";
+        fileStream << "Step Number: " << stepNumber << "\n";
+        try
+        {
+            fileStore().store(fileName, fileStream.str());
+        }
+        catch (const runtime_error&)
+        {
+            throw StepError("Fisierul de iesire " + fileName + " nu a putut fi creat.");
+        }
+
+        prompt << "Fisierul de iesire a fost generat cu succes." << "\n";
+    }
+
+
+    std::string getStepType() const override
+    {
+        return "Output Step";
+    }
+
+    std::string getFileName() const override
+    {
+        return fileName;
+    }
+
+    std::string getDescription() const override
+    {
+        return std::to_string(stepNumber) + " - " + fileName + " - " + title + " - " + description;
+    }
+    void writeDetailsToFile(ostream &file) const override
+{
+    file << "OUTPUT Step" << "\n";
+    file << "Title: " << title << "\n";
+    file << "Text: " << description << "\n";
+    file << "\n";
+}
+
+    void saveState(BinaryWriter& writer) const override
+    {
+        writer.writeString(fileName);
+    }
+
+    void loadState(BinaryReader& reader) override
+    {
+        fileName = reader.readString();
+    }
+
+
+    Step* clone() const override
+    {
+        return new OutputStep(*this);
+    }
+
+    size_t memoryFootprint() const override
+    {
+        return sizeof(*this) + heapBytes(fileName) + heapBytes(title) + heapBytes(description);
+    }
+
+    vector<string> getDefinition() const override
+    {
+        return {"output", to_string(stepNumber), fileName, title, description};
+    }
+
+    void synthesizeInput(string& input, minstd_rand&) const override
+    {
+        input += "\n" + (fileName.empty() ? string("output.txt") : fileName);
+    }
+};
+
+
+// Pasii identici din procese diferite (acelasi tip si aceeasi definitie) sunt pastrati o singura data. Procesele
+// importate sau reincarcate de pe disc isi iau pasii de aici; un pas comun nu este modificat niciodata, iar procesul
+// care ruleaza primeste intai copii proprii (copy-on-write), deci impart pasii doar procesele care nu ruleaza,
+// de obicei aproape tot catalogul. Pool-ul tine referinte slabe: un pas dispare odata cu ultimul proces care il foloseste.
+class StepPool
+{
+private:
+    mutable mutex poolMutex;
+    unordered_map<string, weak_ptr<Step>> steps;
+    size_t reuseCount = 0;
+    size_t cleanupThreshold = 1024;
+
+    static string keyOf(const Step& step)
+    {
+        string key = typeid(step).name();
+        for (const string& field : step.getDefinition())
+        {
+            key += '\0';
+            key += to_string(field.size());
+            key += ':';
+            key += field;
+        }
+        return key;
+    }
+
+    // Intrarile pasilor care nu mai sunt folositi; apelat cu pool-ul blocat, cand tabela s-a dublat
+    void removeExpired()
+    {
+        for (auto it = steps.begin(); it != steps.end();)
+        {
+            it = it->second.expired() ? steps.erase(it) : next(it);
+        }
+        cleanupThreshold = max<size_t>(1024, steps.size() * 2);
+    }
+
+public:
+    // Pasul comun echivalent cu step, daca exista; altfel step devine pasul comun. Pasul trebuie sa fie proaspat
+    // construit din definitie, fara stare de executie.
+    shared_ptr<Step> intern(const shared_ptr<Step>& step)
+    {
+        if (!step->isShareable())
+        {
+            return step;
+        }
+        string key = keyOf(*step);
+        lock_guard<mutex> guard(poolMutex);
+        weak_ptr<Step>& entry = steps[key];
+        shared_ptr<Step> existing = entry.lock();
+        if (existing)
+        {
+            reuseCount++;
+            return existing;
+        }
+        step->shared = true;
+        entry = step;
+        if (steps.size() >= cleanupThreshold)
+        {
+            removeExpired();
+        }
+        return step;
+    }
+
+    // Pasii comuni folositi inca de cel putin un proces si memoria lor
+    size_t getStepCount(size_t& bytes) const
+    {
+        lock_guard<mutex> guard(poolMutex);
+        size_t count = 0;
+        bytes = 0;
+        for (const auto& entry : steps)
+        {
+            shared_ptr<Step> step = entry.second.lock();
+            if (step)
+            {
+                count++;
+                bytes += step->memoryFootprint() + entry.first.capacity();
+            }
+        }
+        return count;
+    }
+
+    size_t getReuseCount() const
+    {
+        lock_guard<mutex> guard(poolMutex);
+        return reuseCount;
+    }
+};
+
+StepPool stepPool;
+
+
+// Conditie de salt: dupa pasul fromStep, daca rezultatul sau numeric respecta comparatia,
+// executia continua direct de la targetStep (pasii dintre ele sunt marcati ca sariti)
+struct StepTransition
+{
+    size_t fromStep;
+    string comparison;  // "<", "<=", ">", ">=", "==", "!="
+    double threshold;
+    size_t targetStep;  // Egal cu numarul de pasi pentru a termina procesul
+};
+
+// Forma precompilata a unei conditii, folosita in tabela de salturi
+struct CompiledTransition
+{
+    enum Comparison { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+    Comparison comparison;
+    double threshold;
+    size_t targetStep;
+
+    bool matches(double value) const
+    {
+        switch (comparison)
+        {
+        case Less:
+            return value < threshold;
+        case LessEqual:
+            return value <= threshold;
+        case Greater:
+            return value > threshold;
+        case GreaterEqual:
+            return value >= threshold;
+        case Equal:
+            return value == threshold;
+        case NotEqual:
+            return value != threshold;
+        }
+        return false;
+    }
+
+    static Comparison parseComparison(const string& text)
+    {
+        if (text == "<") return Less;
+        if (text == "<=") return LessEqual;
+        if (text == ">") return Greater;
+        if (text == ">=") return GreaterEqual;
+        if (text == "==" || text == "=") return Equal;
+        if (text == "!=") return NotEqual;
+        throw invalid_argument("Comparatie necunoscuta: " + text);
+    }
+};
+
+// Politica de executie a unui pas: numarul maxim de incercari, durata maxima si asteptarea intre incercari
+struct StepPolicy
+{
+    int maxAttempts = 1;
+    chrono::milliseconds timeout{0};  // 0 = fara limita; o depasire este numarata in statistici, pasul nu este intrerupt
+    chrono::milliseconds backoff{100};
+    double backoffMultiplier = 2.0;
+    chrono::milliseconds maxBackoff{60000};
+
+    // Asteptarea dupa a n-a incercare esuata (n >= 1), crescuta exponential
+    chrono::milliseconds delayForAttempt(int failedAttempts) const
+    {
+        double delay = static_cast<double>(backoff.count()) * pow(backoffMultiplier, failedAttempts - 1);
+        return chrono::milliseconds(static_cast<long long>(min(delay, static_cast<double>(maxBackoff.count()))));
+    }
+};
+
+// Tipul numeric folosit de pasii de calcul ai unui proces
+enum class NumericMode
+{
+    Float,  // Cel mai rapid, precizie de ~7 cifre
+    Double,
+    Decimal  // Virgula fixa cu 4 zecimale, pentru sume de bani
+};
+
+string numericModeName(NumericMode mode)
+{
+    switch (mode)
+    {
+    case NumericMode::Double:
+        return "double";
+    case NumericMode::Decimal:
+        return "zecimal fix";
+    default:
+        return "float";
+    }
+}
+
+// Versiune imutabila a listei de pasi a unui proces.
+// O editare produce o versiune noua care imparte cu cea veche pasii neschimbati.
+struct FlowVersion
+{
+    int number;
+    vector<shared_ptr<Step>> steps;
+    vector<StepTransition> transitions;
+    vector<StepPolicy> policies;  // Aliniata cu steps
+    vector<vector<CompiledTransition>> jumpTable;  // Construita o singura data, la finalizarea versiunii
+    bool hasSharedSteps = false;  // Cel putin un pas din StepPool; rularea are nevoie intai de copii proprii
+
+    // Valideaza conditiile si construieste tabela de salturi, indexata dupa pas
+    void finalize()
+    {
+        hasSharedSteps = any_of(steps.begin(), steps.end(), [](const shared_ptr<Step>& step) { return step->isShared(); });
+        policies.resize(steps.size());
+        jumpTable.assign(steps.size(), vector<CompiledTransition>());
+        for (const StepTransition& transition : transitions)
+        {
+            if (transition.fromStep >= steps.size() || transition.targetStep > steps.size()
+                || transition.targetStep <= transition.fromStep)
+            {
+                throw invalid_argument("Salt invalid de la pasul " + to_string(transition.fromStep + 1)
+                                       + " la pasul " + to_string(transition.targetStep + 1));
+            }
+            jumpTable[transition.fromStep].push_back(CompiledTransition{
+                CompiledTransition::parseComparison(transition.comparison), transition.threshold, transition.targetStep});
+        }
+    }
+
+    // Memoria versiunii, cu tot cu pasii ei
+    size_t memoryFootprint() const
+    {
+        size_t bytes = sizeof(*this) + steps.capacity() * sizeof(shared_ptr<Step>) + transitions.capacity() * sizeof(StepTransition)
+                       + policies.capacity() * sizeof(StepPolicy) + jumpTable.capacity() * sizeof(vector<CompiledTransition>);
+        for (const shared_ptr<Step>& step : steps)
+        {
+            // Pasii comuni sunt numarati o singura data, in raportul pool-ului
+            bytes += step->isShared() ? 0 : step->memoryFootprint();
+        }
+        for (const StepTransition& transition : transitions)
+        {
+            bytes += heapBytes(transition.comparison);
+        }
+        for (const vector<CompiledTransition>& candidates : jumpTable)
+        {
+            bytes += candidates.capacity() * sizeof(CompiledTransition);
+        }
+        return bytes;
+    }
+
+    // Primul salt a carui conditie este indeplinita; altfel pasul urmator
+    size_t nextStep(size_t index) const
+    {
+        const vector<CompiledTransition>& candidates = jumpTable[index];
+        double value;
+        if (!candidates.empty() && steps[index]->getNumericResult(value))
+        {
+            for (const CompiledTransition& candidate : candidates)
+            {
+                if (candidate.matches(value))
+                {
+                    return candidate.targetStep;
+                }
+            }
+        }
+        return index + 1;
+    }
+};
+
+enum class RunStatus { Completed, RetryScheduled, Failed };
+
+struct RunOutcome
+{
+    RunStatus status;
+    chrono::milliseconds retryDelay;  // Valabil pentru RetryScheduled
+    string error;
+};
+
+// Contoarele unui tip de pas
+struct StepTypeStats
+{
+    long long executions = 0;
+    long long errors = 0;
+    long long overruns = 0;  // Executii reusite care au depasit timpul din politica pasului
+};
+
+// Copie consistenta a statisticilor unui proces, folosita de analiza tuturor proceselor
+struct FlowStatistics
+{
+    int startCount;
+    int completionCount;
+    size_t skippedScreens;
+    size_t errorScreens;
+    unordered_map<string, StepTypeStats> stepTypes;
+    vector<long long> runDurationsMicros;  // Ultimele rulari terminate (finalizate sau esuate)
+};
+
+string checkpointDirectory;  // Activat cu --checkpoint-dir <director>; fara el rularile nu scriu checkpoint-uri
+
+class Flow
+{
+private:
+    string name;
+    shared_ptr<const FlowVersion> currentVersion;  // Citita si inlocuita atomic
+    time_t creationTime;
+    int startCount;  // Numărul de porniri ale procesului
+    int completionCount;  // Numărul de finalizări ale procesului
+    size_t skippedScreens;  // Numărul ecranelor sărite
+    size_t errorScreens;  // Numărul ecranelor de eroare
+    int totalErrors;  // Numărul total de erori pentru analiza medie
+    bool isCompleted;  // Flag pentru a verifica dacă procesul a fost finalizat
+    size_t currentStep;  // Indexul pasului care urmeaza sa fie executat
+    int failedAttempts;  // Incercarile esuate ale pasului curent
+    bool retryPending;  // Rularea curenta asteapta reincercarea unui pas
+    mutex runMutex;  // O singura rulare a aceluiasi proces la un moment dat
+    mutex editMutex;  // Editarile sunt serializate intre ele, dar nu blocheaza rularile
+    function<void(const Flow&)> versionListener;  // Anuntat la fiecare versiune noua (de exemplu de indexul de cautare)
+    mutable mutex statsMutex;  // Protejeaza contoarele, ca analiza sa le poata citi in timpul unei rulari
+    unordered_map<string, StepTypeStats> stepTypeStats;  // Executii si erori pe tip de pas
+    deque<long long> runDurations;  // Durata ultimelor rulari, in microsecunde
+    chrono::steady_clock::time_point runStarted;
+    bool isReplica;  // Replicile din testele de incarcare nu scriu checkpoint-uri, statistici sau jurnal
+    atomic<NumericMode> numericMode;  // Tipul numeric al pasilor de calcul adaugati procesului
+    atomic<long long> lastUsed;  // Ultima folosire (ceas monoton, microsecunde), pentru alegerea proceselor evacuate
+
+    static const size_t RUN_HISTORY_LIMIT = 1024;
+
+    void recordStep(const string& stepType, bool failed, bool overran = false)
+    {
+        if (isReplica)
+        {
+            return;
+        }
+        lock_guard<mutex> guard(statsMutex);
+        StepTypeStats& stats = stepTypeStats[stepType];
+        stats.executions++;
+        if (failed)
+        {
+            stats.errors++;
+        }
+        if (overran)
+        {
+            stats.overruns++;
+        }
+    }
+
+    void recordRunFinished(bool completed, chrono::steady_clock::time_point started)
+    {
+        if (isReplica)
+        {
+            return;
+        }
+        long long duration = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started).count();
+        lock_guard<mutex> guard(statsMutex);
+        if (completed)
+        {
+            completionCount++;
+        }
+        runDurations.push_back(duration);
+        if (runDurations.size() > RUN_HISTORY_LIMIT)
+        {
+            runDurations.pop_front();
+        }
+        if (runJournal)
+        {
+            runJournal->record(name, completed, duration);
+        }
+    }
+
+    FlowVersion nextVersion() const
+    {
+        FlowVersion next = *getVersion();
+        next.number++;
+        return next;
+    }
+
+    // Versiunea este finalizata (validata si cu tabela de salturi construita) inainte de publicare
+    void publish(FlowVersion&& next)
+    {
+        next.finalize();
+        atomic_store(&currentVersion, make_shared<const FlowVersion>(move(next)));
+        if (versionListener)
+        {
+            versionListener(*this);
+        }
+    }
+
+    static const uint32_t CHECKPOINT_MAGIC = 0x324B4346;  // "FCK2"
+
+    // Numele vine si de la clienti (CREATE, import), deci doar numele simple devin nume de fisier;
+    // celelalte (cu '/', spatii, ".." etc.) sunt inlocuite de hash-ul lor, in directorul de checkpoint-uri
+    static string checkpointPath(const string& flowName)
+    {
+        bool simple = !flowName.empty() && flowName[0] != '.' && all_of(flowName.begin(), flowName.end(), [](unsigned char c)
+        {
+            return isalnum(c) || c == '_' || c == '-' || c == '.';
+        });
+        if (simple)
+        {
+            return checkpointDirectory + "/" + flowName + ".ckpt";
+        }
+        char hashed[32];
+        snprintf(hashed, sizeof(hashed), "%016llx", static_cast<unsigned long long>(ResultCache::hashKey(flowName)));
+        return checkpointDirectory + "/flow-" + hashed + ".ckpt";
+    }
+
+    bool checkpointsEnabled() const
+    {
+        return !isReplica && !checkpointDirectory.empty();
+    }
+
+    // Salveaza pozitia curenta si starea pasilor intr-un fisier binar
+    void saveCheckpoint(const FlowVersion& version) const
+    {
+        if (!checkpointsEnabled())
+        {
+            return;
+        }
+        BinaryWriter writer;
+        writer.writeU32(CHECKPOINT_MAGIC);
+        writer.writeVarint(static_cast<uint64_t>(version.number));
+        writer.writeVarint(currentStep);
+        writer.writeVarint(version.steps.size());
+        for (const shared_ptr<Step>& step : version.steps)
+        {
+            BinaryWriter stepWriter;
+            step->saveState(stepWriter);
+            writer.writeString(step->getStepType());
+            writer.writeString(stepWriter.buffer());
+        }
+
+        // Scriem intr-un fisier temporar, il sincronizam pe disc si abia apoi il redenumim, ca un crash
+        // sau o cadere de tensiune sa nu lase un checkpoint partial sau gol
+        string path = checkpointPath(name);
+        string temporaryPath = path + ".tmp";
+        int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            cerr << "Eroare la salvarea checkpoint-ului pentru " << name << "\n";
+            return;
+        }
+        const string& data = writer.buffer();
+        size_t offset = 0;
+        while (offset < data.size())
+        {
+            ssize_t written = ::write(fd, data.data() + offset, data.size() - offset);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written < 0)
+            {
+                break;
+            }
+            offset += static_cast<size_t>(written);
+        }
+        bool synced = offset == data.size() && fsync(fd) == 0;
+        ::close(fd);
+        if (!synced)
+        {
+            remove(temporaryPath.c_str());
+            cerr << "Eroare la salvarea checkpoint-ului pentru " << name << "\n";
+            return;
+        }
+        if (rename(temporaryPath.c_str(), path.c_str()) != 0)
+        {
+            remove(temporaryPath.c_str());
+            cerr << "Eroare la salvarea checkpoint-ului pentru " << name << "\n";
+            return;
+        }
+
+        // Redenumirea devine durabila abia dupa sincronizarea directorului
+        int directoryFd = ::open(checkpointDirectory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (directoryFd >= 0)
+        {
+            fsync(directoryFd);
+            ::close(directoryFd);
+        }
+    }
+
+    // Reincarca un checkpoint facut pe aceeasi versiune a pasilor; intoarce false daca nu exista
+    bool restoreCheckpoint(const FlowVersion& version)
+    {
+        if (!checkpointsEnabled())
+        {
+            return false;
+        }
+        ifstream checkpointFile(checkpointPath(name), ios::binary);
+        if (!checkpointFile.is_open())
+        {
+            return false;
+        }
+        string data((istreambuf_iterator<char>(checkpointFile)), istreambuf_iterator<char>());
+
+        try
+        {
+            BinaryReader reader(data);
+            if (reader.readU32() != CHECKPOINT_MAGIC)
+            {
+                return false;
+            }
+            uint64_t savedVersion = reader.readVarint();
+            uint64_t savedStep = reader.readVarint();
+            uint64_t savedCount = reader.readVarint();
+            if (savedVersion != static_cast<uint64_t>(version.number) || savedCount != version.steps.size() || savedStep > savedCount)
+            {
+                return false;
+            }
+
+            // Verificam intai toate tipurile, apoi aplicam starea
+            vector<string> states;
+            for (const shared_ptr<Step>& step : version.steps)
+            {
+                if (reader.readString() != step->getStepType())
+                {
+                    return false;
+                }
+                states.push_back(reader.readString());
+            }
+            for (size_t i = 0; i < version.steps.size(); ++i)
+            {
+                BinaryReader stepReader(states[i]);
+                version.steps[i]->loadState(stepReader);
+            }
+            currentStep = savedStep;
+            return true;
+        }
+        catch (const runtime_error&)
+        {
+            return false;
+        }
+    }
+
+    // Fisierele pasilor OUTPUT sunt golite o data, la finalul rularii, nu dupa fiecare pas; o eroare de scriere
+    // amanata de destinatie este atribuita rularii care a produs datele. Intoarce mesajul erorii sau sirul gol.
+    static string flushOutputFiles()
+    {
+        try
+        {
+            fileStore().flush();
+        }
+        catch (const runtime_error& e)
+        {
+            return string("Fisierele de iesire nu au putut fi scrise: ") + e.what();
+        }
+        return "";
+    }
+
+    void clearCheckpoint() const
+    {
+        if (!isReplica)
+        {
+            clearCheckpoint(name);
+        }
+    }
+
+public:
+    // Un proces sters sau recreat cu acelasi nume nu trebuie sa reia pozitia rularii vechi
+    static void clearCheckpoint(const string& flowName)
+    {
+        if (!checkpointDirectory.empty())
+        {
+            remove(checkpointPath(flowName).c_str());
+        }
+    }
+
+    Flow(const string& n) : name(n), startCount(0), completionCount(0), skippedScreens(0), errorScreens(0), totalErrors(0), isCompleted(false), currentStep(0), failedAttempts(0), retryPending(false), isReplica(false), numericMode(NumericMode::Float), lastUsed(0)
+    {
+        touch();
+        creationTime = time(nullptr);
+        currentVersion = make_shared<const FlowVersion>(FlowVersion{1, {}, {}, {}, {}});
+    }
+
+    // Versiunea curenta; o rulare o pastreaza pana la final, chiar daca procesul este editat intre timp
+    shared_ptr<const FlowVersion> getVersion() const
+    {
+        return atomic_load(&currentVersion);
+    }
+
+    // Copy-on-write: versiunea noua copiaza doar pointerii, pasii neschimbati sunt impartiti
+    void addStep(Step* step)
+    {
+        shared_ptr<Step> added(step);
+        lock_guard<mutex> editGuard(editMutex);
+        FlowVersion next = nextVersion();
+        next.steps.push_back(added);
+        next.policies.push_back(StepPolicy());
+        publish(move(next));
+    }
+
+    void replaceStep(size_t index, Step* step)
+    {
+        shared_ptr<Step> replacement(step);
+        lock_guard<mutex> editGuard(editMutex);
+        FlowVersion next = nextVersion();
+        if (index >= next.steps.size())
+        {
+            throw out_of_range("Pasul " + to_string(index + 1) + " nu exista in procesul " + name);
+        }
+        next.steps[index] = replacement;
+        publish(move(next));
+    }
+
+    // Conditiile care pornesc din pasul sters sau sar la el sunt eliminate, celelalte sunt renumerotate
+    void removeStep(size_t index)
+    {
+        lock_guard<mutex> editGuard(editMutex);
+        FlowVersion next = nextVersion();
+        if (index >= next.steps.size())
+        {
+            throw out_of_range("Pasul " + to_string(index + 1) + " nu exista in procesul " + name);
+        }
+        next.steps.erase(next.steps.begin() + index);
+        next.policies.erase(next.policies.begin() + index);
+
+        vector<StepTransition> kept;
+        for (StepTransition transition : next.transitions)
+        {
+            if (transition.fromStep == index || transition.targetStep == index)
+            {
+                continue;
+            }
+            if (transition.fromStep > index)
+            {
+                transition.fromStep--;
+            }
+            if (transition.targetStep > index)
+            {
+                transition.targetStep--;
+            }
+            kept.push_back(transition);
+        }
+        next.transitions = kept;
+        publish(move(next));
+    }
+
+    // Versiunea curenta cu pasi proprii (copiati), a carei stare nu este impartita cu alte rulari
+    FlowVersion copyVersion() const
+    {
+        FlowVersion copy = *getVersion();
+        unordered_map<const Step*, Step*> copies;
+        for (shared_ptr<Step>& step : copy.steps)
+        {
+            shared_ptr<Step> duplicate(step->clone());
+            copies[step.get()] = duplicate.get();
+            step = duplicate;
+        }
+        for (shared_ptr<Step>& step : copy.steps)
+        {
+            step->remapInputs(copies);
+        }
+        copy.finalize();
+        return copy;
+    }
+
+    // Copy-on-write pentru pasii din StepPool: pasii comuni (si calculele care ii folosesc ca intrari) sunt inlocuiti
+    // cu copii proprii. Numarul versiunii ramane acelasi, pentru ca definitia nu se schimba si checkpoint-ul ramane valabil.
+    shared_ptr<const FlowVersion> privateVersion()
+    {
+        lock_guard<mutex> editGuard(editMutex);
+        FlowVersion next = *getVersion();
+        if (!next.hasSharedSteps)
+        {
+            return getVersion();
+        }
+        unordered_map<const Step*, Step*> copies;
+        for (shared_ptr<Step>& step : next.steps)
+        {
+            if (step->isShared() || !step->isShareable())
+            {
+                shared_ptr<Step> own(step->clone());
+                copies[step.get()] = own.get();
+                step = own;
+            }
+        }
+        for (shared_ptr<Step>& step : next.steps)
+        {
+            step->remapInputs(copies);
+        }
+        publish(move(next));
+        return getVersion();
+    }
+
+    // Replica cu pasi copiati si aceeasi versiune, care poate rula in paralel cu originalul
+    shared_ptr<Flow> clone() const
+    {
+        FlowVersion copy = copyVersion();
+        shared_ptr<Flow> replica = make_shared<Flow>(name);
+        replica->isReplica = true;
+        replica->numericMode = numericMode.load();
+        replica->publish(move(copy));
+        return replica;
+    }
+
+    NumericMode getNumericMode() const
+    {
+        return numericMode;
+    }
+
+    void setNumericMode(NumericMode mode)
+    {
+        numericMode = mode;
+    }
+
+    void setVersionListener(function<void(const Flow&)> listener)
+    {
+        lock_guard<mutex> editGuard(editMutex);
+        versionListener = listener;
+    }
+
+    void setStepPolicy(size_t index, const StepPolicy& policy)
+    {
+        lock_guard<mutex> editGuard(editMutex);
+        FlowVersion next = nextVersion();
+        if (index >= next.steps.size())
+        {
+            throw out_of_range("Pasul " + to_string(index + 1) + " nu exista in procesul " + name);
+        }
+        next.policies[index] = policy;
+        publish(move(next));
+    }
+
+    // Adauga un salt conditionat; indicii sunt de la 0, iar targetStep == numarul de pasi termina procesul
+    void addTransition(size_t fromStep, const string& comparison, double threshold, size_t targetStep)
+    {
+        lock_guard<mutex> editGuard(editMutex);
+        FlowVersion next = nextVersion();
+        next.transitions.push_back(StepTransition{fromStep, comparison, threshold, targetStep});
+        publish(move(next));
+    }
+
+    vector<shared_ptr<Step>> getSteps() const
+    {
+        return getVersion()->steps;
+    }
+
+    // Inlocuieste toata definitia intr-o singura versiune noua; saltul invalid lasa procesul neschimbat
+    void define(vector<shared_ptr<Step>> steps, vector<StepTransition> transitions, vector<StepPolicy> policies)
+    {
+        lock_guard<mutex> editGuard(editMutex);
+        FlowVersion next = nextVersion();
+        next.steps = move(steps);
+        next.transitions = move(transitions);
+        next.policies = move(policies);
+        publish(move(next));
+    }
+
+
+    // Ruleaza procesul, reluand de la pasul salvat in checkpoint daca o rulare anterioara a fost intrerupta.
+    // Un pas care esueaza este marcat ca ecran de eroare; daca politica lui mai permite incercari, rularea
+    // se opreste cu RetryScheduled, iar apelantul o reia dupa retryDelay fara sa tina un thread blocat.
+    // Checkpoint-ul ramane pe pasul care a esuat. Un pas reusit care a depasit timpul permis este doar
+    // numarat: efectele lui (de exemplu fisierele scrise) au avut deja loc si nu trebuie repetate.
+    RunOutcome run()
+    {
+        lock_guard<mutex> runGuard(runMutex);
+        touch();
+        shared_ptr<const FlowVersion> version = getVersion();
+        if (version->hasSharedSteps)
+        {
+            version = privateVersion();
+        }
+        const vector<shared_ptr<Step>>& steps = version->steps;
+
+        if (!retryPending)
+        {
+            lock_guard<mutex> guard(statsMutex);
+            startCount++;
+            runStarted = chrono::steady_clock::now();
+        }
+        retryPending = false;
+        isCompleted = false;
+        if (restoreCheckpoint(*version) && currentStep > 0)
+        {
+            output().write("Procesul " + name + " este reluat de la pasul " + to_string(currentStep + 1) + "\n");
+        }
+        else
+        {
+            currentStep = 0;
+        }
+
+        while (currentStep < steps.size())
+        {
+            const StepPolicy& policy = version->policies[currentStep];
+            string stepType = steps[currentStep]->getStepType();
+            uint64_t ioBefore = fileIoBytes;
+            if (executionTracer)
+            {
+                executionTracer->beginStep(name, currentStep, stepType);
+            }
+            chrono::steady_clock::time_point started = chrono::steady_clock::now();
+            string failure;
+            try
+            {
+                steps[currentStep]->execute();
+            }
+            catch (const exception& e)
+            {
+                failure = e.what();
+            }
+            bool overran = policy.timeout.count() > 0 && chrono::steady_clock::now() - started > policy.timeout;
+            if (executionTracer)
+            {
+                executionTracer->endStep(name, currentStep, stepType, fileIoBytes - ioBefore);
+            }
+
+            recordStep(stepType, !failure.empty(), failure.empty() && overran);
+            if (!failure.empty())
+            {
+                markScreenError(static_cast<int>(currentStep + 1));
+                failedAttempts++;
+                if (failedAttempts < policy.maxAttempts)
+                {
+                    retryPending = true;
+                    return RunOutcome{RunStatus::RetryScheduled, policy.delayForAttempt(failedAttempts), failure};
+                }
+                failedAttempts = 0;
+                recordRunFinished(false, runStarted);
+                return RunOutcome{RunStatus::Failed, chrono::milliseconds(0), failure};
+            }
+            failedAttempts = 0;
+
+            // Tabela de salturi decide pasul urmator; pasii peste care se sare nu se executa
+            size_t next = version->nextStep(currentStep);
+            for (size_t skipped = currentStep + 1; skipped < next; ++skipped)
+            {
+                markScreenSkipped(static_cast<int>(skipped + 1));
+            }
+            currentStep = next;
+            saveCheckpoint(*version);
+        }
+
+        string flushFailure = flushOutputFiles();
+        recordRunFinished(flushFailure.empty(), runStarted);
+        isCompleted = flushFailure.empty();
+        currentStep = 0;
+        clearCheckpoint();
+        if (!flushFailure.empty())
+        {
+            return RunOutcome{RunStatus::Failed, chrono::milliseconds(0), flushFailure};
+        }
+        return RunOutcome{RunStatus::Completed, chrono::milliseconds(0), ""};
+    }
+
+    // Rulare suspendabila pe o copie a versiunii: pozitia si incercarile traiesc in cadrul corutinei,
+    // deci oricate rulari ale aceluiasi proces pot astepta raspunsuri in paralel, fara runMutex si fara thread-uri.
+    // Un pas esuat este reluat imediat (cu o noua intrebare) cat timp politica lui mai permite incercari;
+    // timeout-ul politicii nu se aplica, pentru ca asteptarea raspunsului face parte din pas.
+    StepTask runAsync(shared_ptr<const FlowVersion> version, StepContext& context, string& error)
+    {
+        touch();
+        chrono::steady_clock::time_point started = chrono::steady_clock::now();
+        {
+            lock_guard<mutex> guard(statsMutex);
+            startCount++;
+        }
+
+        size_t index = 0;
+        int attempts = 0;
+        uint64_t traceId = executionTracer ? executionTracer->newAsyncId() : 0;
+        while (index < version->steps.size())
+        {
+            // Pasul poate fi reluat pe alt thread, deci octetii de fisier nu pot fi atribuiti lui
+            string stepType = version->steps[index]->getStepType();
+            if (executionTracer)
+            {
+                executionTracer->beginStep(name, index, stepType, traceId);
+            }
+            string failure;
+            try
+            {
+                co_await version->steps[index]->executeAsync(context);
+            }
+            catch (const exception& e)
+            {
+                failure = e.what();
+            }
+            if (executionTracer)
+            {
+                executionTracer->endStep(name, index, stepType, 0, traceId);
+            }
+
+            recordStep(stepType, !failure.empty());
+            if (!failure.empty())
+            {
+                markScreenError(static_cast<int>(index + 1));
+                context.prompt() << "Eroare: " << failure << "\n";
+                if (++attempts < version->policies[index].maxAttempts)
+                {
+                    continue;
+                }
+                recordRunFinished(false, started);
+                error = failure;
+                co_return;
+            }
+            attempts = 0;
+
+            size_t next = version->nextStep(index);
+            for (size_t skipped = index + 1; skipped < next; ++skipped)
+            {
+                markScreenSkipped(static_cast<int>(skipped + 1));
+            }
+            index = next;
+        }
+        error = flushOutputFiles();
+        recordRunFinished(error.empty(), started);
+    }
+
+    size_t getCurrentStep() const
+    {
+        return currentStep;
+    }
+
+    void analyze(ostream& out = cout) const
+    {
+        lock_guard<mutex> guard(statsMutex);
+        out << "Analiza procesului " << name << ":\n";
+        out << "  - Numarul de porniri: " << startCount << "\n";
+        out << "  - Numarul de finalizari: " << completionCount << "\n";
+
+        if (completionCount > 0)
+        {
+            double averageErrors = static_cast<double>(totalErrors) / completionCount;
+            out << "  - Numarul mediu de erori per proces finalizat: " << averageErrors << "\n";
+        }
+        else
+        {
+            out << "  - Procesul nu a fost finalizat niciodata.\n";
+        }
+
+        out << "  - Numarul total de ecrane sarite: " << skippedScreens << "\n";
+        out << "  - Numarul total de ecrane de eroare: " << errorScreens << "\n";
+
+        // Alte informații de analiză pot fi adăugate aici
+    }
+
+    void displayCreationTime() const
+    {
+        cout << "Procesul " << name << " a fost creat la: " << put_time(localtime(&creationTime), "%Y-%m-%d %H:%M:%S") << "\n";
+        cout << "Versiunea curenta a pasilor: " << getVersionNumber() << "\n";
+        cout << "Precizia numerica: " << numericModeName(getNumericMode()) << "\n";
+    }
+
+    void markScreenSkipped(int)
+    {
+        lock_guard<mutex> guard(statsMutex);
+        skippedScreens++;
+    }
+
+    void markScreenError(int)
+    {
+        lock_guard<mutex> guard(statsMutex);
+        errorScreens++;
+        totalErrors++;
+    }
+
+    FlowStatistics getStatistics() const
+    {
+        lock_guard<mutex> guard(statsMutex);
+        return FlowStatistics{startCount, completionCount, skippedScreens, errorScreens, stepTypeStats,
+                              vector<long long>(runDurations.begin(), runDurations.end())};
+    }
+
+    void touch()
+    {
+        lastUsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    long long getLastUsed() const
+    {
+        return lastUsed;
+    }
+
+    // Memoria ocupata de proces: versiunea curenta cu pasii ei, istoricul rularilor si statisticile
+    size_t memoryFootprint() const
+    {
+        size_t bytes = sizeof(*this) + heapBytes(name) + getVersion()->memoryFootprint();
+        lock_guard<mutex> guard(statsMutex);
+        bytes += runDurations.size() * sizeof(long long);
+        for (const auto& entry : stepTypeStats)
+        {
+            bytes += sizeof(entry) + heapBytes(entry.first) + 2 * sizeof(void*);  // Nodul si intrarea din tabela
+        }
+        return bytes;
+    }
+
+    // Pastreaza doar ultimele keep durate de rulare
+    void trimHistory(size_t keep)
+    {
+        lock_guard<mutex> guard(statsMutex);
+        if (runDurations.size() > keep)
+        {
+            runDurations.erase(runDurations.begin(), runDurations.end() - static_cast<ptrdiff_t>(keep));
+            runDurations.shrink_to_fit();
+        }
+    }
+
+    // Tot ce nu se regaseste in definitia CSV: statisticile, versiunea si starea pasilor, pentru evacuarea pe disc
+    void writeSnapshot(BinaryWriter& writer) const
+    {
+        shared_ptr<const FlowVersion> version = getVersion();
+        lock_guard<mutex> guard(statsMutex);
+        writer.writeVarint(static_cast<uint64_t>(creationTime));
+        writer.writeVarint(static_cast<uint64_t>(version->number));
+        writer.writeVarint(static_cast<uint64_t>(startCount));
+        writer.writeVarint(static_cast<uint64_t>(completionCount));
+        writer.writeVarint(static_cast<uint64_t>(totalErrors));
+        writer.writeVarint(skippedScreens);
+        writer.writeVarint(errorScreens);
+        writer.writeVarint(stepTypeStats.size());
+        for (const auto& entry : stepTypeStats)
+        {
+            writer.writeString(entry.first);
+            writer.writeVarint(static_cast<uint64_t>(entry.second.executions));
+            writer.writeVarint(static_cast<uint64_t>(entry.second.errors));
+            writer.writeVarint(static_cast<uint64_t>(entry.second.overruns));
+        }
+        writer.writeVarint(runDurations.size());
+        for (long long duration : runDurations)
+        {
+            writer.writeVarint(static_cast<uint64_t>(duration));
+        }
+        writer.writeVarint(version->steps.size());
+        for (const shared_ptr<Step>& step : version->steps)
+        {
+            BinaryWriter stepWriter;
+            step->saveState(stepWriter);
+            writer.writeString(step->getStepType());
+            writer.writeString(stepWriter.buffer());
+        }
+    }
+
+    // Aplicat pe procesul reconstruit din definitia CSV; arunca runtime_error daca pasii nu corespund
+    void readSnapshot(BinaryReader& reader)
+    {
+        lock_guard<mutex> editGuard(editMutex);
+        FlowVersion restored = *getVersion();
+        unique_lock<mutex> guard(statsMutex);
+        creationTime = static_cast<time_t>(reader.readVarint());
+        restored.number = static_cast<int>(reader.readVarint());
+        startCount = static_cast<int>(reader.readVarint());
+        completionCount = static_cast<int>(reader.readVarint());
+        totalErrors = static_cast<int>(reader.readVarint());
+        skippedScreens = reader.readVarint();
+        errorScreens = reader.readVarint();
+        for (uint64_t count = reader.readVarint(); count > 0; --count)
+        {
+            StepTypeStats& stats = stepTypeStats[reader.readString()];
+            stats.executions = static_cast<long long>(reader.readVarint());
+            stats.errors = static_cast<long long>(reader.readVarint());
+            stats.overruns = static_cast<long long>(reader.readVarint());
+        }
+        for (uint64_t count = reader.readVarint(); count > 0; --count)
+        {
+            runDurations.push_back(static_cast<long long>(reader.readVarint()));
+        }
+        if (reader.readVarint() != restored.steps.size())
+        {
+            throw runtime_error("Numarul pasilor din snapshot nu corespunde definitiei procesului " + name);
+        }
+        unordered_map<const Step*, Step*> copies;
+        for (shared_ptr<Step>& step : restored.steps)
+        {
+            if (reader.readString() != step->getStepType())
+            {
+                throw runtime_error("Tipul pasilor din snapshot nu corespunde definitiei procesului " + name);
+            }
+            string state = reader.readString();
+            if (step->isShared())
+            {
+                // Un pas comun ramane impartit daca are deja starea salvata; altfel procesul primeste o copie
+                BinaryWriter current;
+                step->saveState(current);
+                if (current.buffer() == state)
+                {
+                    continue;
+                }
+                shared_ptr<Step> own(step->clone());
+                copies[step.get()] = own.get();
+                step = own;
+            }
+            BinaryReader stepReader(state);
+            step->loadState(stepReader);
+        }
+        for (shared_ptr<Step>& step : restored.steps)
+        {
+            step->remapInputs(copies);
+        }
+        guard.unlock();
+
+        // Numarul versiunii este pastrat, ca un checkpoint facut inainte de evacuare sa ramana valabil
+        publish(move(restored));
+    }
+
+    bool isCompletedSuccessfully() const
+    {
+        return isCompleted;
+    }
+
+    int getVersionNumber() const
+    {
+        return getVersion()->number;
+    }
+
+    string getName() const
+    {
+        return name;
+    }
+
+   string getStepsInfo() const
+{
+    string stepsInfo;
+    for (const shared_ptr<Step>& step : getVersion()->steps)
+    {
+        stepsInfo += step->getDescription() + " | ";
+    }
+    return stepsInfo;
+}
+
+
+};
+
+// Raportul agregat peste toate procesele din FlowManager
+// Histograma duratelor cu galeti logaritmici: 16 subdiviziuni pe fiecare putere a lui 2, deci o percentila are
+// eroarea relativa sub 1/16. Are dimensiune fixa si se combina prin adunare, fara sa pastreze fiecare durata.
+class DurationHistogram
+{
+private:
+    static const int SUB_BITS = 4;
+    static const size_t BUCKET_COUNT = (64 - SUB_BITS + 1) << SUB_BITS;
+
+    array<uint64_t, BUCKET_COUNT> counts{};
+    uint64_t total = 0;
+
+    static size_t bucketOf(uint64_t value)
+    {
+        if (value < (uint64_t(1) << SUB_BITS))
+        {
+            return static_cast<size_t>(value);  // Valorile mici au cate un galet propriu
+        }
+        int exponent = 63 - __builtin_clzll(value);
+        uint64_t mantissa = (value >> (exponent - SUB_BITS)) & ((uint64_t(1) << SUB_BITS) - 1);
+        return (static_cast<size_t>(exponent - SUB_BITS + 1) << SUB_BITS) + static_cast<size_t>(mantissa);
+    }
+
+    // Cea mai mare valoare care cade in galet
+    static uint64_t upperBound(size_t bucket)
+    {
+        if (bucket < (size_t(1) << SUB_BITS))
+        {
+            return bucket;
+        }
+        int exponent = static_cast<int>(bucket >> SUB_BITS) + SUB_BITS - 1;
+        uint64_t mantissa = bucket & ((size_t(1) << SUB_BITS) - 1);
+        uint64_t low = (uint64_t(1) << exponent) | (mantissa << (exponent - SUB_BITS));
+        return low + ((uint64_t(1) << (exponent - SUB_BITS)) - 1);
+    }
+
+public:
+    void add(long long value)
+    {
+        counts[bucketOf(static_cast<uint64_t>(max(0LL, value)))]++;
+        total++;
+    }
+
+    void merge(const DurationHistogram& other)
+    {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+    }
+
+    // Percentila prin rangul cel mai apropiat, rotunjita la marginea de sus a galetului
+    long long percentile(double percent) const
+    {
+        if (total == 0)
+        {
+            return 0;
+        }
+        uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(ceil(percent / 100.0 * total)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            seen += counts[i];
+            if (seen >= rank)
+            {
+                return static_cast<long long>(upperBound(i));
+            }
+        }
+        return static_cast<long long>(upperBound(BUCKET_COUNT - 1));
+    }
+};
+
+struct FleetReport
+{
+    size_t flowCount = 0;
+    long long startCount = 0;
+    long long completionCount = 0;
+    long long skippedScreens = 0;
+    long long errorScreens = 0;
+    unordered_map<string, StepTypeStats> stepTypes;
+    DurationHistogram runDurations;  // Rapoartele partiale au dimensiune fixa, oricate rulari ar avea procesele
+
+    // Combina rezultatul partial al altui thread in acest raport
+    void merge(const FleetReport& other)
+    {
+        flowCount += other.flowCount;
+        startCount += other.startCount;
+        completionCount += other.completionCount;
+        skippedScreens += other.skippedScreens;
+        errorScreens += other.errorScreens;
+        for (const auto& entry : other.stepTypes)
+        {
+            stepTypes[entry.first].executions += entry.second.executions;
+            stepTypes[entry.first].errors += entry.second.errors;
+            stepTypes[entry.first].overruns += entry.second.overruns;
+        }
+        runDurations.merge(other.runDurations);
+    }
+
+    void add(const FlowStatistics& stats)
+    {
+        flowCount++;
+        startCount += stats.startCount;
+        completionCount += stats.completionCount;
+        skippedScreens += static_cast<long long>(stats.skippedScreens);
+        errorScreens += static_cast<long long>(stats.errorScreens);
+        for (const auto& entry : stats.stepTypes)
+        {
+            stepTypes[entry.first].executions += entry.second.executions;
+            stepTypes[entry.first].errors += entry.second.errors;
+            stepTypes[entry.first].overruns += entry.second.overruns;
+        }
+        for (long long duration : stats.runDurationsMicros)
+        {
+            runDurations.add(duration);
+        }
+    }
+
+    double completionRatio() const
+    {
+        return startCount > 0 ? static_cast<double>(completionCount) / startCount : 0.0;
+    }
+
+    long long durationPercentile(double percentile) const
+    {
+        return runDurations.percentile(percentile);
+    }
+
+    void print(ostream& out) const
+    {
+        out << "Analiza tuturor proceselor:\n";
+        out << "  - Numarul de procese: " << flowCount << "\n";
+        out << "  - Numarul de porniri: " << startCount << "\n";
+        out << "  - Numarul de finalizari: " << completionCount << "\n";
+        out << "  - Rata de finalizare: " << completionRatio() * 100 << "%\n";
+        out << "  - Numarul total de ecrane sarite: " << skippedScreens << "\n";
+        out << "  - Numarul total de ecrane de eroare: " << errorScreens << "\n";
+        out << "  - Durata rularilor (us): p50 " << durationPercentile(50) << ", p90 " << durationPercentile(90)
+            << ", p99 " << durationPercentile(99) << "\n";
+
+        vector<string> types;
+        for (const auto& entry : stepTypes)
+        {
+            types.push_back(entry.first);
+        }
+        sort(types.begin(), types.end());
+        for (const string& type : types)
+        {
+            const StepTypeStats& stats = stepTypes.at(type);
+            double errorRate = stats.executions > 0 ? 100.0 * stats.errors / stats.executions : 0.0;
+            out << "  - " << type << ": " << stats.executions << " executii, " << stats.errors
+                << " erori (" << errorRate << "%)";
+            if (stats.overruns > 0)
+            {
+                out << ", " << stats.overruns << " peste timpul permis";
+            }
+            out << "\n";
+        }
+    }
+};
+
+// Memoria proceselor din FlowManager si a cache-ului de rezultate, comparata cu bugetele configurate
+struct MemoryReport
+{
+    size_t loadedFlows = 0;
+    size_t evictedFlows = 0;
+    size_t flowBytes = 0;
+    size_t cacheBytes = 0;
+    size_t totalBudget = 0;  // 0 = fara limita
+    size_t flowBudget = 0;
+    size_t evictions = 0;
+    size_t reloads = 0;
+    size_t sharedSteps = 0;
+    size_t sharedStepBytes = 0;
+    size_t sharedStepReuses = 0;
+    size_t tracerBytes = 0;  // Cronologia pasilor (--trace-out)
+    vector<pair<string, size_t>> largestFlows;
+
+    void print(ostream& out = cout) const
+    {
+        out << "Raport de memorie:\n";
+        out << "  - Procese in memorie: " << loadedFlows << ", evacuate pe disc: " << evictedFlows << "\n";
+        out << "  - Memoria proceselor: " << flowBytes << " octeti\n";
+        out << "  - Memoria cache-ului de rezultate: " << cacheBytes << " octeti\n";
+        out << "  - Pasi comuni: " << sharedSteps << " (" << sharedStepBytes << " octeti), refolositi de " << sharedStepReuses << " ori\n";
+        out << "  - Memoria cronologiei pasilor: " << tracerBytes << " octeti\n";
+        out << "  - Bugetul total: " << (totalBudget > 0 ? to_string(totalBudget) + " octeti" : string("nelimitat")) << "\n";
+        out << "  - Bugetul per proces: " << (flowBudget > 0 ? to_string(flowBudget) + " octeti" : string("nelimitat")) << "\n";
+        out << "  - Evacuari: " << evictions << ", reincarcari: " << reloads << "\n";
+        for (const pair<string, size_t>& flow : largestFlows)
+        {
+            out << "  - " << flow.first << ": " << flow.second << " octeti\n";
+        }
+    }
+};
+
+// Pasii numerici ai builder-ului, in tipul numeric ales pentru proces
+Step* createNumberInputStep(NumericMode mode, const string& description)
+{
+    switch (mode)
+    {
+    case NumericMode::Double:
+        return new DoubleNumberInputStep(description);
+    case NumericMode::Decimal:
+        return new DecimalNumberInputStep(description);
+    default:
+        return new NumberInputStep(description);
+    }
+}
+
+// Definitia unui proces ca fisier CSV cu un rand per pas: proces,tip,parametri...
+//   precision,<float|double|decimal>       inaintea pasilor numerici
+//   title,<titlu>,<subtitlu>               text,<titlu>,<text>            textinput,<descriere>,<raspuns>
+//   number,<descriere>                     calculus,<nr intrari>,<operatie> (foloseste ultimii pasi number liberi)
+//   display,<nr>,<continut>,<fisier>       textfile,<descriere>,<fisier>  csvfile,<descriere>,<fisier>
+//   output,<nr>,<fisier>,<titlu>,<descriere>
+//   jump,<de la>,<comparatie>,<prag>,<la>  retry,<pas>,<incercari>,<timeout ms>,<asteptare ms>[,<multiplicator>,<maxim ms>]
+// Pasii sunt numerotati de la 1. Randurile goale si cele care incep cu # sunt ignorate.
+// Campurile pot fi intre ghilimele, cu "" pentru ghilimele in interior.
+// Formatul este folosit de importul in masa si de evacuarea proceselor pe disc.
+class FlowDefinitionCodec
+{
+public:
+    struct Row
+    {
+        size_t lineNumber;
+        vector<string> fields;
+    };
+
+private:
+    // Starea construirii unui proces, rand cu rand
+    struct FlowBuilder
+    {
+        NumericMode mode = NumericMode::Float;
+        vector<shared_ptr<Step>> steps;
+        vector<Step*> freeNumberSteps;  // Pasi number care nu sunt inca intrari ale unui calculus
+        vector<StepTransition> transitions;
+        vector<StepPolicy> policies;
+        bool hasNumericSteps = false;
+    };
+
+    static long long parseInteger(const string& text, const string& what)
+    {
+        long long value = 0;
+        from_chars_result parsed = from_chars(text.data(), text.data() + text.size(), value);
+        if (parsed.ec != errc() || parsed.ptr != text.data() + text.size())
+        {
+            throw invalid_argument(what + " invalid: '" + text + "'");
+        }
+        return value;
+    }
+
+    static double parseReal(const string& text, const string& what)
+    {
+        double value = 0;
+        from_chars_result parsed = from_chars(text.data(), text.data() + text.size(), value);
+        if (parsed.ec != errc() || parsed.ptr != text.data() + text.size())
+        {
+            throw invalid_argument(what + " invalid: '" + text + "'");
+        }
+        return value;
+    }
+
+    static void requireFields(const Row& row, size_t count)
+    {
+        if (row.fields.size() != count)
+        {
+            throw invalid_argument("tipul " + row.fields[1] + " are nevoie de " + to_string(count - 2) + " parametri, nu de "
+                                   + to_string(row.fields.size() - 2));
+        }
+    }
+
+    // Pasul cu numarul dat (de la 1), ca index de la 0
+    static size_t stepIndex(const string& text, size_t limit, const string& what)
+    {
+        long long number = parseInteger(text, what);
+        if (number < 1 || static_cast<size_t>(number) > limit)
+        {
+            throw invalid_argument(what + " " + text + " nu exista");
+        }
+        return static_cast<size_t>(number - 1);
+    }
+
+    template<typename T>
+    static Step* buildCalculus(FlowBuilder& builder, size_t inputCount, const string& operation)
+    {
+        CalculusStepT<T>* calculusStep = new CalculusStepT<T>(static_cast<int>(inputCount), operation);
+        vector<Step*>::iterator firstInput = builder.freeNumberSteps.end() - static_cast<ptrdiff_t>(inputCount);
+        for (vector<Step*>::iterator input = firstInput; input != builder.freeNumberSteps.end(); ++input)
+        {
+            calculusStep->addInputStep(static_cast<NumberInputStepT<T>*>(*input));
+        }
+        builder.freeNumberSteps.erase(firstInput, builder.freeNumberSteps.end());
+        return calculusStep;
+    }
+
+    static void applyRow(FlowBuilder& builder, const Row& row)
+    {
+        const vector<string>& f = row.fields;
+        const string& type = f[1];
+        Step* step = nullptr;
+
+        if (type == "precision")
+        {
+            requireFields(row, 3);
+            if (builder.hasNumericSteps)
+            {
+                throw invalid_argument("precizia trebuie declarata inaintea pasilor numerici");
+            }
+            if (f[2] == "float") builder.mode = NumericMode::Float;
+            else if (f[2] == "double") builder.mode = NumericMode::Double;
+            else if (f[2] == "decimal") builder.mode = NumericMode::Decimal;
+            else throw invalid_argument("precizie necunoscuta: " + f[2]);
+            return;
+        }
+        if (type == "jump")
+        {
+            requireFields(row, 6);
+            size_t fromStep = stepIndex(f[2], builder.steps.size(), "pasul");
+            double threshold = parseReal(f[4], "pragul");
+            long long target = parseInteger(f[5], "pasul tinta");
+            CompiledTransition::parseComparison(f[3]);
+            builder.transitions.push_back(StepTransition{fromStep, f[3], threshold, static_cast<size_t>(max(0LL, target - 1))});
+            return;
+        }
+        if (type == "retry")
+        {
+            if (row.fields.size() != 8)
+            {
+                requireFields(row, 6);
+            }
+            size_t index = stepIndex(f[2], builder.steps.size(), "pasul");
+            StepPolicy policy;
+            policy.maxAttempts = static_cast<int>(parseInteger(f[3], "numarul de incercari"));
+            policy.timeout = chrono::milliseconds(parseInteger(f[4], "timeout-ul"));
+            policy.backoff = chrono::milliseconds(parseInteger(f[5], "asteptarea"));
+            if (f.size() == 8)
+            {
+                policy.backoffMultiplier = parseReal(f[6], "multiplicatorul");
+                policy.maxBackoff = chrono::milliseconds(parseInteger(f[7], "asteptarea maxima"));
+            }
+            if (policy.maxAttempts < 1)
+            {
+                throw invalid_argument("numarul de incercari trebuie sa fie cel putin 1");
+            }
+            builder.policies.resize(builder.steps.size());
+            builder.policies[index] = policy;
+            return;
+        }
+
+        if (type == "title")
+        {
+            requireFields(row, 4);
+            step = new TitleStep(f[2], f[3]);
+        }
+        else if (type == "text")
+        {
+            requireFields(row, 4);
+            step = new TextStep(f[2], f[3]);
+        }
+        else if (type == "textinput")
+        {
+            requireFields(row, 4);
+            step = new TextInputStep(f[2], f[3]);
+        }
+        else if (type == "number")
+        {
+            requireFields(row, 3);
+            step = createNumberInputStep(builder.mode, f[2]);
+            builder.freeNumberSteps.push_back(step);
+            builder.hasNumericSteps = true;
+        }
+        else if (type == "calculus")
+        {
+            requireFields(row, 4);
+            long long inputCount = parseInteger(f[2], "numarul de intrari");
+            if (inputCount < 1 || static_cast<size_t>(inputCount) > builder.freeNumberSteps.size())
+            {
+                throw invalid_argument("calculus are nevoie de " + f[2] + " pasi number inaintea lui, dar sunt disponibili "
+                                       + to_string(builder.freeNumberSteps.size()));
+            }
+            switch (builder.mode)
+            {
+            case NumericMode::Double:
+                step = buildCalculus<double>(builder, static_cast<size_t>(inputCount), f[3]);
+                break;
+            case NumericMode::Decimal:
+                step = buildCalculus<FixedDecimal>(builder, static_cast<size_t>(inputCount), f[3]);
+                break;
+            default:
+                step = buildCalculus<float>(builder, static_cast<size_t>(inputCount), f[3]);
+                break;
+            }
+            builder.hasNumericSteps = true;
+        }
+        else if (type == "display")
+        {
+            requireFields(row, 5);
+            step = new DisplayStep(static_cast<int>(parseInteger(f[2], "numarul pasului")), f[3], f[4]);
+        }
+        else if (type == "textfile")
+        {
+            requireFields(row, 4);
+            step = new TextFileInputStep(f[2], f[3]);
+        }
+        else if (type == "csvfile")
+        {
+            requireFields(row, 4);
+            step = new CSVFileInputStep(f[2], f[3]);
+        }
+        else if (type == "output")
+        {
+            requireFields(row, 6);
+            step = new OutputStep(static_cast<int>(parseInteger(f[2], "numarul pasului")), f[3], f[4], f[5]);
+        }
+        else
+        {
+            throw invalid_argument("tip de pas necunoscut: " + type);
+        }
+        builder.steps.push_back(shared_ptr<Step>(step));
+    }
+
+public:
+    static vector<string> splitCsvLine(const string& line)
+    {
+        vector<string> fields;
+        string field;
+        bool quoted = false;
+        for (size_t i = 0; i < line.size(); ++i)
+        {
+            char c = line[i];
+            if (quoted)
+            {
+                if (c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+                {
+                    field += '"';
+                    ++i;
+                }
+                else if (c == '"')
+                {
+                    quoted = false;
+                }
+                else
+                {
+                    field += c;
+                }
+            }
+            else if (c == '"')
+            {
+                quoted = true;
+            }
+            else if (c == ',')
+            {
+                fields.push_back(field);
+                field.clear();
+            }
+            else if (c != '\r')
+            {
+                field += c;
+            }
+        }
+        fields.push_back(field);
+        return fields;
+    }
+
+    static string joinCsvLine(const vector<string>& fields)
+    {
+        string line;
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            if (i > 0)
+            {
+                line += ',';
+            }
+            if (fields[i].find_first_of(",\"\n\r") == string::npos && !fields[i].empty() && fields[i][0] != '#')
+            {
+                line += fields[i];
+                continue;
+            }
+            line += '"';
+            for (char c : fields[i])
+            {
+                line += c == '"' ? string("\"\"") : string(1, c);
+            }
+            line += '"';
+        }
+        return line;
+    }
+
+    // Construieste un proces; erorile sunt adunate cu numarul liniei, iar procesul invalid este ignorat.
+    // Fara shareSteps pasii nu trec prin pool (verificari care nu pastreaza procesul construit).
+    static shared_ptr<Flow> build(const string& name, const vector<const Row*>& rows, vector<string>& errors, bool shareSteps = true)
+    {
+        FlowBuilder builder;
+        size_t errorCount = errors.size();
+        for (const Row* row : rows)
+        {
+            try
+            {
+                applyRow(builder, *row);
+            }
+            catch (const exception& e)
+            {
+                errors.push_back("linia " + to_string(row->lineNumber) + ": " + e.what());
+            }
+        }
+        if (errors.size() != errorCount)
+        {
+            return nullptr;
+        }
+
+        // Pasii identici cu ai proceselor deja incarcate sunt luati din pool; calculele isi muta intrarile pe ei
+        unordered_map<const Step*, Step*> pooled;
+        for (shared_ptr<Step>& step : builder.steps)
+        {
+            if (!shareSteps)
+            {
+                break;
+            }
+            shared_ptr<Step> shared = stepPool.intern(step);
+            if (shared != step)
+            {
+                pooled[step.get()] = shared.get();
+                step = shared;
+            }
+        }
+        for (shared_ptr<Step>& step : builder.steps)
+        {
+            step->remapInputs(pooled);
+        }
+
+        shared_ptr<Flow> flow = make_shared<Flow>(name);
+        flow->setNumericMode(builder.mode);
+        try
+        {
+            flow->define(move(builder.steps), move(builder.transitions), move(builder.policies));
+        }
+        catch (const exception& e)
+        {
+            errors.push_back("procesul " + name + ": " + e.what());
+            return nullptr;
+        }
+        return flow;
+    }
+
+    // Randurile care recreeaza versiunea curenta a procesului
+    static string describe(const Flow& flow)
+    {
+        const string& name = flow.getName();
+        shared_ptr<const FlowVersion> version = flow.getVersion();
+        const char* modes[] = {"float", "double", "decimal"};
+
+        string text = joinCsvLine({name, "precision", modes[static_cast<int>(flow.getNumericMode())]}) + "\n";
+        for (const shared_ptr<Step>& step : version->steps)
+        {
+            vector<string> fields = step->getDefinition();
+            fields.insert(fields.begin(), name);
+            text += joinCsvLine(fields) + "\n";
+        }
+        for (const StepTransition& transition : version->transitions)
+        {
+            text += joinCsvLine({name, "jump", to_string(transition.fromStep + 1), transition.comparison,
+                                 formatNumber(transition.threshold), to_string(transition.targetStep + 1)}) + "\n";
+        }
+        StepPolicy defaults;
+        for (size_t i = 0; i < version->policies.size(); ++i)
+        {
+            const StepPolicy& policy = version->policies[i];
+            if (policy.maxAttempts == defaults.maxAttempts && policy.timeout == defaults.timeout && policy.backoff == defaults.backoff
+                && policy.backoffMultiplier == defaults.backoffMultiplier && policy.maxBackoff == defaults.maxBackoff)
+            {
+                continue;
+            }
+            text += joinCsvLine({name, "retry", to_string(i + 1), to_string(policy.maxAttempts), to_string(policy.timeout.count()),
+                                 to_string(policy.backoff.count()), formatNumber(policy.backoffMultiplier),
+                                 to_string(policy.maxBackoff.count())}) + "\n";
+        }
+        return text;
+    }
+
+    static shared_ptr<Flow> parse(const string& name, const string& text, vector<string>& errors, bool shareSteps = true)
+    {
+        vector<Row> rows;
+        istringstream lines(text);
+        string line;
+        while (getline(lines, line))
+        {
+            rows.push_back(Row{rows.size() + 1, splitCsvLine(line)});
+        }
+        vector<const Row*> flowRows;
+        for (const Row& row : rows)
+        {
+            if (row.fields.size() < 2 || row.fields[0] != name)
+            {
+                errors.push_back("linia " + to_string(row.lineNumber) + ": randul nu apartine procesului " + name);
+                return nullptr;
+            }
+            flowRows.push_back(&row);
+        }
+        return build(name, flowRows, errors, shareSteps);
+    }
+};
+
+// Index inversat peste atributele pasilor: fiecare termen ("type:...", "file:...", "word:...")
+// duce la procesele care il contin. Este actualizat incremental la adaugarea, editarea si stergerea proceselor.
+class StepIndex
+{
+private:
+    unordered_map<string, unordered_map<string, int>> flowsByTerm;  // termen -> proces -> numar de aparitii
+    unordered_map<string, vector<string>> termsByFlow;
+    mutable shared_mutex indexMutex;
+
+    static string normalize(const string& text)
+    {
+        string result = text;
+        transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        return result;
+    }
+
+    static void addWords(const string& text, vector<string>& terms)
+    {
+        string word;
+        for (char c : text + " ")
+        {
+            if (isalnum(static_cast<unsigned char>(c)))
+            {
+                word += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+            }
+            else if (!word.empty())
+            {
+                terms.push_back("word:" + word);
+                word.clear();
+            }
+        }
+    }
+
+    void removeLocked(const string& flowName)
+    {
+        auto found = termsByFlow.find(flowName);
+        if (found == termsByFlow.end())
+        {
+            return;
+        }
+        for (const string& term : found->second)
+        {
+            auto flows = flowsByTerm.find(term);
+            if (flows != flowsByTerm.end() && --flows->second[flowName] <= 0)
+            {
+                flows->second.erase(flowName);
+                if (flows->second.empty())
+                {
+                    flowsByTerm.erase(flows);
+                }
+            }
+        }
+        termsByFlow.erase(found);
+    }
+
+public:
+    static vector<string> termsForStep(const Step& step)
+    {
+        vector<string> terms;
+        terms.push_back("type:" + normalize(step.getStepType()));
+        string fileName = step.getFileName();
+        if (!fileName.empty())
+        {
+            terms.push_back("file:" + normalize(fileName));
+        }
+        addWords(step.getDescription(), terms);
+        return terms;
+    }
+
+    // Termenii unei cautari, separati prin spatii; ghilimelele grupeaza spatiile oriunde in termen, deci
+    // type:"display step" si "type:display step" sunt acelasi termen
+    static vector<string> parseQuery(const string& query)
+    {
+        vector<string> terms;
+        string term;
+        bool quoted = false;
+        for (char c : query + " ")
+        {
+            if (c == '"')
+            {
+                quoted = !quoted;
+            }
+            else if (!quoted && isspace(static_cast<unsigned char>(c)))
+            {
+                if (!term.empty())
+                {
+                    terms.push_back(term);
+                }
+                term.clear();
+            }
+            else
+            {
+                term += c;
+            }
+        }
+        if (!term.empty())
+        {
+            terms.push_back(term);  // Ghilimele neinchise
+        }
+        return terms;
+    }
+
+    // Inlocuieste termenii procesului cu cei ai pasilor sai actuali. Dupa o rulare termenii raman de obicei
+    // aceiasi, iar atunci ajunge lock-ul partajat, deci rularile nu se serializeaza pe index.
+    void indexFlow(const string& flowName, const vector<shared_ptr<Step>>& steps)
+    {
+        vector<string> terms;
+        for (const shared_ptr<Step>& step : steps)
+        {
+            vector<string> stepTerms = termsForStep(*step);
+            terms.insert(terms.end(), stepTerms.begin(), stepTerms.end());
+        }
+
+        {
+            shared_lock<shared_mutex> guard(indexMutex);
+            auto found = termsByFlow.find(flowName);
+            if (found != termsByFlow.end() && found->second == terms)
+            {
+                return;
+            }
+        }
+        unique_lock<shared_mutex> guard(indexMutex);
+        removeLocked(flowName);
+        for (const string& term : terms)
+        {
+            flowsByTerm[term][flowName]++;
+        }
+        termsByFlow[flowName] = move(terms);
+    }
+
+    void removeFlow(const string& flowName)
+    {
+        unique_lock<shared_mutex> guard(indexMutex);
+        removeLocked(flowName);
+    }
+
+    // Procesele care contin toti termenii; un termen fara prefix este cautat ca "word:"
+    vector<string> search(const vector<string>& queryTerms) const
+    {
+        shared_lock<shared_mutex> guard(indexMutex);
+        vector<string> result;
+        bool first = true;
+        for (string term : queryTerms)
+        {
+            term = normalize(term);
+            if (term.find(':') == string::npos)
+            {
+                term = "word:" + term;
+            }
+
+            vector<string> matches;
+            auto flows = flowsByTerm.find(term);
+            if (flows != flowsByTerm.end())
+            {
+                for (const auto& entry : flows->second)
+                {
+                    matches.push_back(entry.first);
+                }
+            }
+            sort(matches.begin(), matches.end());
+
+            if (first)
+            {
+                result = matches;
+                first = false;
+            }
+            else
+            {
+                vector<string> intersection;
+                set_intersection(result.begin(), result.end(), matches.begin(), matches.end(), back_inserter(intersection));
+                result = intersection;
+            }
+        }
+        return result;
+    }
+};
+
+// Procesele sunt impartite pe shard-uri dupa hash-ul numelui; fiecare shard are propriul lock,
+// astfel incat crearea, stergerea si cautarea pot rula in paralel din mai multe thread-uri
+class FlowManager
+{
+private:
+    static const size_t SHARD_COUNT = 16;
+
+    struct FlowShard
+    {
+        mutable shared_mutex shardMutex;
+        unordered_map<string, shared_ptr<Flow>> flows;
+        unordered_map<string, string> evicted;  // Procesele evacuate pe disc, cu fisierul fiecaruia
+    };
+
+    array<FlowShard, SHARD_COUNT> shards;
+    StepIndex stepIndex;
+
+    // Bugetele de memorie, in octeti; 0 = fara limita
+    size_t totalBudget = 0;
+    size_t flowBudget = 0;
+    string evictDirectory = ".";
+    mutable mutex budgetMutex;
+    mutex evictionMutex;  // O singura evacuare la un moment dat, ca doua thread-uri sa nu scrie acelasi fisier
+    chrono::steady_clock::time_point lastBudgetCheck;
+    atomic<size_t> evictionCount{0};
+    atomic<size_t> reloadCount{0};
+
+    static const uint32_t EVICTED_MAGIC = 0x31564546;  // "FEV1"
+    static const size_t TRIMMED_HISTORY = 64;  // Duratele pastrate de un proces peste bugetul lui
+    static constexpr chrono::seconds BUDGET_CHECK_INTERVAL{1};
+    static constexpr chrono::seconds IDLE_BEFORE_EVICTION{10};  // Un proces peste buget, dar folosit recent, nu este evacuat
+
+    // Indexul urmareste automat versiunile noi ale procesului
+    void track(const shared_ptr<Flow>& flow)
+    {
+        flow->setVersionListener([this](const Flow& changed)
+        {
+            stepIndex.indexFlow(changed.getName(), changed.getSteps());
+        });
+        stepIndex.indexFlow(flow->getName(), flow->getSteps());
+    }
+
+    static size_t shardIndex(const string& name)
+    {
+        return hash<string>()(name) % SHARD_COUNT;
+    }
+
+    FlowShard& shardFor(const string& name)
+    {
+        return shards[shardIndex(name)];
+    }
+
+    string evictedPath(const string& name) const
+    {
+        return evictDirectory + "/" + to_string(ResultCache::hashKey(name)) + ".fev";
+    }
+
+    // Un proces nou sau sters inlocuieste copia evacuata; apelat cu shard-ul blocat exclusiv
+    static void dropEvicted(FlowShard& shard, const string& name)
+    {
+        auto it = shard.evicted.find(name);
+        if (it != shard.evicted.end())
+        {
+            remove(it->second.c_str());
+            shard.evicted.erase(it);
+        }
+    }
+
+    // Procesul evacuat: definitia CSV (FlowDefinitionCodec) urmata de snapshot-ul statisticilor si al starii pasilor
+    static shared_ptr<Flow> loadEvicted(const string& path)
+    {
+        ifstream file(path, ios::binary);
+        if (!file.is_open())
+        {
+            throw runtime_error("Procesul evacuat nu poate fi citit din " + path);
+        }
+        string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+        BinaryReader reader(data);
+        if (reader.readU32() != EVICTED_MAGIC)
+        {
+            throw runtime_error("Fisierul " + path + " nu contine un proces evacuat");
+        }
+        string name = reader.readString();
+        string definition = reader.readString();
+        vector<string> errors;
+        shared_ptr<Flow> flow = FlowDefinitionCodec::parse(name, definition, errors);
+        if (!flow)
+        {
+            throw runtime_error("Definitia procesului evacuat " + name + " este invalida: " + errors.front());
+        }
+        flow->readSnapshot(reader);
+        return flow;
+    }
+
+    // Procesele evacuate sunt reincarcate si inregistrate la prima folosire
+    shared_ptr<Flow> reload(const string& name)
+    {
+        FlowShard& shard = shardFor(name);
+        shared_ptr<Flow> flow;
+        {
+            unique_lock<shared_mutex> guard(shard.shardMutex);
+            auto loaded = shard.flows.find(name);
+            if (loaded != shard.flows.end())
+            {
+                return loaded->second;  // Reincarcat intre timp de alt thread
+            }
+            auto it = shard.evicted.find(name);
+            if (it == shard.evicted.end())
+            {
+                return nullptr;
+            }
+            try
+            {
+                flow = loadEvicted(it->second);
+            }
+            catch (const runtime_error& e)
+            {
+                cerr << "Eroare: " << e.what() << "\n";
+                return nullptr;
+            }
+            remove(it->second.c_str());
+            shard.evicted.erase(it);
+            shard.flows[name] = flow;
+        }
+        reloadCount++;
+        track(flow);
+        return flow;
+    }
+
+    vector<shared_ptr<Flow>> getLoadedFlows() const
+    {
+        vector<shared_ptr<Flow>> result;
+        for (const FlowShard& shard : shards)
+        {
+            shared_lock<shared_mutex> guard(shard.shardMutex);
+            for (const auto& entry : shard.flows)
+            {
+                result.push_back(entry.second);
+            }
+        }
+        return result;
+    }
+
+    // Procesul incarcat sau, pentru unul evacuat, o copie citita de pe disc doar pentru apelant, fara sa fie
+    // reincarcat in memorie; nullptr daca procesul nu (mai) exista
+    shared_ptr<Flow> peekFlow(const string& name) const
+    {
+        const FlowShard& shard = shards[shardIndex(name)];
+        string path;
+        {
+            shared_lock<shared_mutex> guard(shard.shardMutex);
+            auto it = shard.flows.find(name);
+            if (it != shard.flows.end())
+            {
+                return it->second;
+            }
+            auto evictedFlow = shard.evicted.find(name);
+            if (evictedFlow == shard.evicted.end())
+            {
+                return nullptr;
+            }
+            path = evictedFlow->second;
+        }
+        try
+        {
+            return loadEvicted(path);
+        }
+        catch (const runtime_error& e)
+        {
+            // Fisierul dispare cand procesul este reincarcat intre timp
+            shared_lock<shared_mutex> guard(shard.shardMutex);
+            auto it = shard.flows.find(name);
+            if (it != shard.flows.end())
+            {
+                return it->second;
+            }
+            cerr << "Eroare: " << e.what() << "\n";
+            return nullptr;
+        }
+    }
+
+public:
+    // Viziteaza procesele names[begin, end) pe rand. Un proces evacuat este citit de pe disc doar pe durata
+    // vizitei lui, deci salvarea catalogului si analiza tin in memorie cel mult un proces evacuat odata.
+    void visitFlows(const vector<string>& names, size_t begin, size_t end, const function<void(const Flow&)>& visit) const
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            shared_ptr<Flow> flow = peekFlow(names[i]);
+            if (flow)
+            {
+                visit(*flow);
+            }
+        }
+    }
+
+    // Toate procesele, ordonate dupa nume
+    void forEachFlow(const function<void(const Flow&)>& visit) const
+    {
+        vector<string> names = getFlowNames();
+        visitFlows(names, 0, names.size(), visit);
+    }
+
+    size_t getFlowCount() const
+    {
+        size_t count = 0;
+        for (const FlowShard& shard : shards)
+        {
+            shared_lock<shared_mutex> guard(shard.shardMutex);
+            count += shard.flows.size() + shard.evicted.size();
+        }
+        return count;
+    }
+
+    // Numele tuturor proceselor, inclusiv ale celor evacuate, fara sa le incarce
+    vector<string> getFlowNames() const
+    {
+        vector<string> names;
+        for (const FlowShard& shard : shards)
+        {
+            shared_lock<shared_mutex> guard(shard.shardMutex);
+            for (const auto& entry : shard.flows)
+            {
+                names.push_back(entry.first);
+            }
+            for (const auto& entry : shard.evicted)
+            {
+                names.push_back(entry.first);
+            }
+        }
+        sort(names.begin(), names.end());
+        return names;
+    }
+
+    // Un proces nou cu acelasi nume il inlocuieste pe cel vechi
+    shared_ptr<Flow> createFlow(const string& name)
+    {
+        shared_ptr<Flow> newFlow = make_shared<Flow>(name);
+        Flow::clearCheckpoint(name);
+        FlowShard& shard = shardFor(name);
+        {
+            unique_lock<shared_mutex> guard(shard.shardMutex);
+            dropEvicted(shard, name);
+            shard.flows[name] = newFlow;
+        }
+        track(newFlow);
+        enforceMemoryBudget();
+        return newFlow;
+    }
+
+    void displayAvailableSteps()
+    {
+        cout << "Available steps:\n";
+        cout << "1. Title Step\n";
+        cout << "2. Text Step\n";
+        cout << "3. Text Input Step\n";
+        cout << "4. Number Input Step\n";
+        cout << "5. Calculus Step\n";
+        cout << "6. Display Step\n";
+        cout << "7. Text File Input Step\n";
+        cout << "8. CSV File Input Step\n";
+        cout << "9. Output Step\n";
+        cout << "10. End Step\n";
+    }
+
+    void addStepToFlow(Flow* flow, Step* step)
+    {
+
+        flow->addStep(step);
+        try
+        {
+            step->execute();
+            fileStore().flush();  // Pasul ruleaza singur, in afara unei rulari care sa goleasca destinatia
+        }
+        catch (const exception& e)
+        {
+            cout << "Eroare: " << e.what() << "\n";
+        }
+        reindexFlow(*flow);
+        enforceMemoryBudget();
+    }
+
+    // Rulare din consola: asteapta intre reincercari, pentru ca utilizatorul urmareste rularea
+    RunOutcome runFlow(Flow* flow)
+    {
+        RunOutcome outcome;
+        if (traceLog)
+        {
+            // Intrarile consumate de pasi sunt copiate intr-o urma care poate fi rejucata
+            RecordingStreamBuf recorder(cin.rdbuf());
+            istream recordedInput(&recorder);
+            recordedInput.tie(&cout);
+            StepIOScope scope(recordedInput, cout);
+            chrono::steady_clock::time_point started = chrono::steady_clock::now();
+            outcome = runWithRetries(flow);
+            uint64_t duration = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started).count();
+            traceLog->append(RunTrace{flow->getName(), recorder.getRecorded(), duration, outcome.status == RunStatus::Completed});
+        }
+        else
+        {
+            outcome = runWithRetries(flow);
+        }
+        reindexFlow(*flow);
+        enforceMemoryBudget();
+        return outcome;
+    }
+
+    RunOutcome runWithRetries(Flow* flow)
+    {
+        RunOutcome outcome = flow->run();
+        while (outcome.status == RunStatus::RetryScheduled)
+        {
+            cout << "Eroare: " << outcome.error << " Reincercare in " << outcome.retryDelay.count() << " ms.\n";
+            this_thread::sleep_for(outcome.retryDelay);
+            outcome = flow->run();
+        }
+        return outcome;
+    }
+
+    // Procesul este eliberat cand nu mai este folosit de nicio rulare in curs
+    bool deleteFlow(const string& name)
+    {
+        FlowShard& shard = shardFor(name);
+        shared_ptr<Flow> removed;
+        {
+            unique_lock<shared_mutex> guard(shard.shardMutex);
+            auto it = shard.flows.find(name);
+            if (it == shard.flows.end())
+            {
+                if (shard.evicted.find(name) == shard.evicted.end())
+                {
+                    return false;
+                }
+                dropEvicted(shard, name);
+                guard.unlock();
+                stepIndex.removeFlow(name);
+                Flow::clearCheckpoint(name);
+                return true;
+            }
+            removed = it->second;
+            shard.flows.erase(it);
+        }
+        removed->setVersionListener(nullptr);
+        stepIndex.removeFlow(name);
+        Flow::clearCheckpoint(name);
+        return true;
+    }
+
+    shared_ptr<Flow> getFlowByName(const string& name)
+    {
+        FlowShard& shard = shardFor(name);
+        {
+            shared_lock<shared_mutex> guard(shard.shardMutex);
+            auto it = shard.flows.find(name);
+            if (it != shard.flows.end())
+            {
+                it->second->touch();
+                return it->second;
+            }
+            if (shard.evicted.find(name) == shard.evicted.end())
+            {
+                return nullptr;
+            }
+        }
+        return reload(name);
+    }
+
+    void analyzeFlow(Flow* flow, ostream& out = cout) const
+    {
+        flow->analyze(out);
+    }
+
+    // Reducere paralela: fiecare thread agrega un interval de procese, apoi rezultatele partiale se combina
+    // Procesele evacuate sunt citite de thread-ul care le analizeaza, cate unul odata
+    FleetReport analyzeAll(size_t threadCount = thread::hardware_concurrency()) const
+    {
+        vector<string> names = getFlowNames();
+        threadCount = max<size_t>(1, min(threadCount, names.size()));
+
+        vector<FleetReport> partials(threadCount);
+        vector<thread> workers;
+        size_t chunkSize = (names.size() + threadCount - 1) / threadCount;
+        for (size_t t = 0; t < threadCount; ++t)
+        {
+            workers.emplace_back([&, t]()
+            {
+                size_t begin = min(names.size(), t * chunkSize);
+                size_t end = min(names.size(), begin + chunkSize);
+                visitFlows(names, begin, end, [&](const Flow& flow)
+                {
+                    partials[t].add(flow.getStatistics());
+                });
+            });
+        }
+        for (thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        FleetReport report;
+        for (const FleetReport& partial : partials)
+        {
+            report.merge(partial);
+        }
+        return report;
+    }
+
+    void addFlow(Flow* flow)
+{
+    shared_ptr<Flow> added(flow);
+    FlowShard& shard = shardFor(flow->getName());
+    {
+        unique_lock<shared_mutex> guard(shard.shardMutex);
+        dropEvicted(shard, flow->getName());
+        shard.flows[flow->getName()] = added;
+    }
+    track(added);
+}
+
+    // Inregistrare in masa: fiecare shard este blocat o singura data pentru toate procesele lui
+    void addFlows(const vector<shared_ptr<Flow>>& flows)
+    {
+        array<vector<const shared_ptr<Flow>*>, SHARD_COUNT> byShard;
+        for (const shared_ptr<Flow>& flow : flows)
+        {
+            byShard[shardIndex(flow->getName())].push_back(&flow);
+        }
+        for (size_t i = 0; i < SHARD_COUNT; ++i)
+        {
+            if (byShard[i].empty())
+            {
+                continue;
+            }
+            unique_lock<shared_mutex> guard(shards[i].shardMutex);
+            for (const shared_ptr<Flow>* flow : byShard[i])
+            {
+                dropEvicted(shards[i], (*flow)->getName());
+                shards[i].flows[(*flow)->getName()] = *flow;
+            }
+        }
+        for (const shared_ptr<Flow>& flow : flows)
+        {
+            track(flow);
+        }
+    }
+
+    // Pasii isi pot schimba atributele (de exemplu numele fisierului) cand sunt executati
+    void reindexFlow(const Flow& flow)
+    {
+        stepIndex.indexFlow(flow.getName(), flow.getSteps());
+    }
+
+    vector<string> searchFlows(const vector<string>& terms) const
+    {
+        return stepIndex.search(terms);
+    }
+
+    void setMemoryBudget(size_t total, size_t perFlow, const string& directory)
+    {
+        lock_guard<mutex> guard(budgetMutex);
+        totalBudget = total;
+        flowBudget = perFlow;
+        evictDirectory = directory;
+    }
+
+    // Scrie procesul pe disc si il scoate din memorie. Procesul ramane in indexul de cautare si este reincarcat
+    // de getFlowByName. Nu este evacuat daca este folosit (rulare, sesiune sau alta referinta) ori daca definitia
+    // lui nu poate fi reconstruita din CSV.
+    // Serializarea si scrierea pe disc se fac fara lock-ul shard-ului; lock-ul exclusiv este luat doar pentru
+    // inlocuirea procesului cu calea fisierului, daca intre timp procesul nu a fost folosit
+    bool evict(const string& name)
+    {
+        lock_guard<mutex> evictionGuard(evictionMutex);
+        FlowShard& shard = shardFor(name);
+        shared_ptr<Flow> flow;
+        {
+            shared_lock<shared_mutex> guard(shard.shardMutex);
+            auto it = shard.flows.find(name);
+            if (it == shard.flows.end() || it->second.use_count() > 1)
+            {
+                return false;
+            }
+            flow = it->second;
+        }
+        long long usedBefore = flow->getLastUsed();
+
+        // Definitia trebuie sa se reconstruiasca identic; verificarea nu trece pasii prin pool
+        string definition = FlowDefinitionCodec::describe(*flow);
+        vector<string> errors;
+        shared_ptr<Flow> check = FlowDefinitionCodec::parse(name, definition, errors, false);
+        if (!check || FlowDefinitionCodec::describe(*check) != definition)
+        {
+            return false;
+        }
+
+        BinaryWriter writer;
+        writer.writeU32(EVICTED_MAGIC);
+        writer.writeString(name);
+        writer.writeString(definition);
+        flow->writeSnapshot(writer);
+
+        // Fisier temporar redenumit, ca un crash sa nu lase un proces evacuat pe jumatate
+        string path = evictedPath(name);
+        string temporaryPath = path + ".tmp";
+        ofstream file(temporaryPath, ios::binary | ios::trunc);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        file.write(writer.buffer().data(), writer.buffer().size());
+        file.close();
+        if (!file || rename(temporaryPath.c_str(), path.c_str()) != 0)
+        {
+            remove(temporaryPath.c_str());
+            return false;
+        }
+
+        // Procesul folosit, inlocuit sau sters dupa serializare ramane in memorie, iar fisierul este aruncat
+        unique_lock<shared_mutex> guard(shard.shardMutex);
+        auto it = shard.flows.find(name);
+        if (it == shard.flows.end() || it->second != flow || flow.use_count() > 2 || flow->getLastUsed() != usedBefore)
+        {
+            guard.unlock();
+            remove(path.c_str());
+            return false;
+        }
+        it->second->setVersionListener(nullptr);
+        shard.flows.erase(it);
+        shard.evicted[name] = path;
+        evictionCount++;
+        return true;
+    }
+
+    // Cel mult o data pe secunda (sau imediat, cu force): procesele peste bugetul lor isi scurteaza istoricul
+    // rularilor si, daca nu au mai fost folosite de IDLE_BEFORE_EVICTION, sunt evacuate; apoi, cat timp memoria
+    // proceselor si a cache-ului depaseste bugetul total, sunt evacuate procesele folosite cel mai demult.
+    void enforceMemoryBudget(bool force = false)
+    {
+        size_t total;
+        size_t perFlow;
+        {
+            lock_guard<mutex> guard(budgetMutex);
+            chrono::steady_clock::time_point now = chrono::steady_clock::now();
+            if ((totalBudget == 0 && flowBudget == 0) || (!force && now - lastBudgetCheck < BUDGET_CHECK_INTERVAL))
+            {
+                return;
+            }
+            lastBudgetCheck = now;
+            total = totalBudget;
+            perFlow = flowBudget;
+        }
+
+        struct Candidate
+        {
+            string name;
+            long long lastUsed;
+            size_t bytes;
+        };
+        long long idleLimit = chrono::duration_cast<chrono::microseconds>(
+            chrono::steady_clock::now().time_since_epoch() - IDLE_BEFORE_EVICTION).count();
+        vector<Candidate> candidates;
+        size_t sharedStepBytes;
+        stepPool.getStepCount(sharedStepBytes);
+        size_t used = resultCache.getUsedBytes() + sharedStepBytes + (executionTracer ? executionTracer->memoryBytes() : 0);
+        {
+            vector<shared_ptr<Flow>> loaded = getLoadedFlows();
+            for (const shared_ptr<Flow>& flow : loaded)
+            {
+                size_t bytes = flow->memoryFootprint();
+                if (perFlow > 0 && bytes > perFlow)
+                {
+                    flow->trimHistory(TRIMMED_HISTORY);
+                    bytes = flow->memoryFootprint();
+                }
+                used += bytes;
+                candidates.push_back(Candidate{flow->getName(), flow->getLastUsed(), bytes});
+            }
+        }  // Referintele din loaded ar impiedica evacuarea
+
+        sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b)
+        {
+            return a.lastUsed < b.lastUsed;
+        });
+        for (Candidate& candidate : candidates)
+        {
+            bool overFlowBudget = perFlow > 0 && candidate.bytes > perFlow && candidate.lastUsed < idleLimit;
+            bool overTotalBudget = total > 0 && used > total;
+            if ((overFlowBudget || overTotalBudget) && evict(candidate.name))
+            {
+                used -= candidate.bytes;
+            }
+        }
+    }
+
+    MemoryReport memoryReport() const
+    {
+        MemoryReport report;
+        {
+            lock_guard<mutex> guard(budgetMutex);
+            report.totalBudget = totalBudget;
+            report.flowBudget = flowBudget;
+        }
+        report.cacheBytes = resultCache.getUsedBytes();
+        report.sharedSteps = stepPool.getStepCount(report.sharedStepBytes);
+        report.sharedStepReuses = stepPool.getReuseCount();
+        report.tracerBytes = executionTracer ? executionTracer->memoryBytes() : 0;
+        report.evictions = evictionCount;
+        report.reloads = reloadCount;
+        for (const FlowShard& shard : shards)
+        {
+            shared_lock<shared_mutex> guard(shard.shardMutex);
+            report.evictedFlows += shard.evicted.size();
+        }
+        for (const shared_ptr<Flow>& flow : getLoadedFlows())
+        {
+            size_t bytes = flow->memoryFootprint();
+            report.loadedFlows++;
+            report.flowBytes += bytes;
+            report.largestFlows.emplace_back(flow->getName(), bytes);
+        }
+        sort(report.largestFlows.begin(), report.largestFlows.end(), [](const pair<string, size_t>& a, const pair<string, size_t>& b)
+        {
+            return a.second > b.second;
+        });
+        if (report.largestFlows.size() > 5)
+        {
+            report.largestFlows.resize(5);
+        }
+        return report;
+    }
+
+    void writeFlows(ostream& outputFile) const
+    {
+        forEachFlow([&](const Flow& flow)
+        {
+            outputFile << "Numele procesului: " << flow.getName() << "\n";
+
+            // Adăugați detaliile fiecărui pas în fișier
+            for (const shared_ptr<Step>& step : flow.getSteps())
+            {
+                step->writeDetailsToFile(outputFile);
+            }
+
+            outputFile << "-------------------------\n";
+        });
+    }
+
+    // Fisierele cu extensia .flz sunt scrise comprimat pe blocuri
+    void saveFlowsToFile(const string& filename) const
+    {
+        if (isCompressedCatalog(filename))
+        {
+            try
+            {
+                CompressedWriter writer(filename);
+                ostringstream catalog;
+                writeFlows(catalog);
+                writer.write(catalog.str());
+                writer.close();
+            }
+            catch (const runtime_error& e)
+            {
+                cerr << e.what() << "\n";
+            }
+            return;
+        }
+
+        ofstream outputFile(filename);
+
+        if (!outputFile.is_open())
+        {
+            cerr << "Eroare la deschiderea fisierului " << filename << "\n";
+            return;
+        }
+
+        writeFlows(outputFile);
+
+        outputFile.close();
+    }
+
+    static bool isCompressedCatalog(const string& filename)
+    {
+        return filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".flz") == 0;
+    }
+
+
+    void displayFlowsFromFile(const string& filename) const
+    {
+        if (CompressedReader::isCompressed(filename))
+        {
+            try
+            {
+                CompressedReader reader(filename);
+                reader.streamTo(output());
+            }
+            catch (const runtime_error& e)
+            {
+                cerr << e.what() << "\n";
+            }
+            return;
+        }
+
+        ifstream inputFile(filename);
+
+        if (!inputFile.is_open())
+        {
+            cerr << "Eroare la deschiderea fisierului " << filename << "\n";
+            return;
+        }
+
+        streamFileToSink(inputFile, output());
+
+        inputFile.close();
+    }
+
+
+
+
+};
+
+
+
+// Clasa pentru pasul de tip final
+class EndStep : public Step
+{
+public:
+    void execute() override
+    {
+        cout << "Sfarsitul procesului. Procesul a fost completat cu succes." << "\n";
+    }
+};
+
+
+
+FlowManager flowManager;
+
+
+// Rezultatul unui test de incarcare; latentele sunt masurate de la momentul programat al pornirii
+struct LoadReport
+{
+    size_t runs = 0;
+    size_t completed = 0;
+    size_t failed = 0;
+    size_t skipped = 0;  // Urme pentru procese care nu exista
+    double elapsedSeconds = 0;
+    vector<long long> latenciesMicros;
+
+    long long latencyPercentile(double percentile)
+    {
+        if (latenciesMicros.empty())
+        {
+            return 0;
+        }
+        size_t rank = static_cast<size_t>(ceil(percentile / 100.0 * latenciesMicros.size()));
+        size_t index = rank > 0 ? rank - 1 : 0;
+        nth_element(latenciesMicros.begin(), latenciesMicros.begin() + index, latenciesMicros.end());
+        return latenciesMicros[index];
+    }
+
+    void print(ostream& out)
+    {
+        out << "Rezultatul testului de incarcare:\n";
+        out << "  - Rulari: " << runs << " (finalizate " << completed << ", esuate " << failed << ", sarite " << skipped << ")\n";
+        out << "  - Durata: " << elapsedSeconds << " s\n";
+        out << "  - Debit: " << (elapsedSeconds > 0 ? (completed + failed) / elapsedSeconds : 0.0) << " rulari/s\n";
+        out << "  - Latenta (us): p50 " << latencyPercentile(50) << ", p90 " << latencyPercentile(90)
+            << ", p99 " << latencyPercentile(99) << ", p99.9 " << latencyPercentile(99.9) << "\n";
+    }
+};
+
+// Rejoaca urme de rulare pe replici ale proceselor, cu concurenta si rata configurabile.
+// Fiecare thread are replicile lui, deci rularile nu se blocheaza intre ele pe runMutex.
+// Rularile nu au efecte vizibile: afisarea si fisierele de iesire sunt aruncate, iar replicile nu scriu
+// checkpoint-uri, statistici sau jurnal.
+class LoadGenerator
+{
+private:
+    FlowManager& manager;
+    size_t concurrency;
+    double rate;  // Porniri pe secunda; 0 inseamna cat de repede se poate
+
+public:
+    LoadGenerator(FlowManager& m, size_t threads, double runsPerSecond)
+        : manager(m), concurrency(max<size_t>(1, threads)), rate(runsPerSecond) {}
+
+    // Urme generate din pasii procesului, cu valori aleatoare dar reproductibile pentru aceeasi samanta
+    static vector<RunTrace> synthesize(const Flow& flow, size_t count, uint32_t seed)
+    {
+        minstd_rand random(seed);
+        vector<shared_ptr<Step>> steps = flow.getSteps();
+        vector<RunTrace> traces;
+        for (size_t i = 0; i < count; ++i)
+        {
+            RunTrace trace{flow.getName(), "", 0, true};
+            for (const shared_ptr<Step>& step : steps)
+            {
+                step->synthesizeInput(trace.input, random);
+            }
+            trace.input += "\n";
+            traces.push_back(move(trace));
+        }
+        return traces;
+    }
+
+    // Ruleaza runs porniri, luand urmele pe rand (ciclic)
+    LoadReport run(const vector<RunTrace>& traces, size_t runs)
+    {
+        LoadReport report;
+        if (traces.empty() || runs == 0)
+        {
+            return report;
+        }
+
+        atomic<size_t> nextRun(0);
+        vector<LoadReport> partials(concurrency);
+        vector<thread> threads;
+        chrono::steady_clock::time_point started = chrono::steady_clock::now();
+        for (size_t t = 0; t < concurrency; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                LoadReport& partial = partials[t];
+                unordered_map<string, shared_ptr<Flow>> replicas;
+                ostream discardedPrompts(nullptr);
+                NullSink discardedOutput;
+                DiscardOutputStore discardedFiles;
+                OutputScope outputScope(discardedOutput, discardedFiles);
+
+                for (size_t index = nextRun++; index < runs; index = nextRun++)
+                {
+                    // Fara rata, fiecare rulare porneste imediat ce thread-ul este liber
+                    chrono::steady_clock::time_point scheduled = chrono::steady_clock::now();
+                    if (rate > 0)
+                    {
+                        scheduled = started;
+                        scheduled += chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(index / rate));
+                        this_thread::sleep_until(scheduled);
+                    }
+
+                    const RunTrace& trace = traces[index % traces.size()];
+                    auto replica = replicas.find(trace.flowName);
+                    if (replica == replicas.end())
+                    {
+                        shared_ptr<Flow> original = manager.getFlowByName(trace.flowName);
+                        replica = replicas.emplace(trace.flowName, original ? original->clone() : nullptr).first;
+                    }
+                    if (!replica->second)
+                    {
+                        partial.skipped++;
+                        continue;
+                    }
+
+                    istringstream input(trace.input);
+                    StepIOScope scope(input, discardedPrompts);
+                    RunOutcome outcome = replica->second->run();
+                    while (outcome.status == RunStatus::RetryScheduled)
+                    {
+                        this_thread::sleep_for(outcome.retryDelay);
+                        outcome = replica->second->run();
+                    }
+
+                    partial.runs++;
+                    if (outcome.status == RunStatus::Completed)
+                    {
+                        partial.completed++;
+                    }
+                    else
+                    {
+                        partial.failed++;
+                    }
+                    partial.latenciesMicros.push_back(
+                        chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - scheduled).count());
+                }
+            });
+        }
+        for (thread& worker : threads)
+        {
+            worker.join();
+        }
+
+        for (LoadReport& partial : partials)
+        {
+            report.runs += partial.runs;
+            report.completed += partial.completed;
+            report.failed += partial.failed;
+            report.skipped += partial.skipped;
+            report.latenciesMicros.insert(report.latenciesMicros.end(), partial.latenciesMicros.begin(), partial.latenciesMicros.end());
+        }
+        report.elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        return report;
+    }
+};
+
+
+// Clasele de prioritate ale cozii de rulare: o clasa este servita doar cand clasele de deasupra ei sunt goale,
+// deci rularile in masa folosesc doar capacitatea ramasa libera
+enum class RunPriority
+{
+    Interactive,
+    Normal,
+    Bulk
+};
+
+const size_t RUN_PRIORITY_COUNT = 3;
+
+const char* runPriorityName(RunPriority priority)
+{
+    const char* names[] = {"interactive", "normal", "bulk"};
+    return names[static_cast<int>(priority)];
+}
+
+bool parseRunPriority(const string& text, RunPriority& priority)
+{
+    for (size_t i = 0; i < RUN_PRIORITY_COUNT; ++i)
+    {
+        if (text == runPriorityName(static_cast<RunPriority>(i)))
+        {
+            priority = static_cast<RunPriority>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Metricile unei clase de prioritate; asteptarea este masurata de la intrarea in coada pana la pornire
+struct RunClassStats
+{
+    size_t queued = 0;
+    size_t peakQueued = 0;
+    size_t admitted = 0;
+    size_t rejected = 0;
+    size_t completed = 0;
+    size_t tenants = 0;
+    vector<long long> waitMicros;  // Ultimele asteptari
+
+    long long waitPercentile(double percentile)
+    {
+        if (waitMicros.empty())
+        {
+            return 0;
+        }
+        size_t rank = static_cast<size_t>(ceil(percentile / 100.0 * waitMicros.size()));
+        size_t index = rank > 0 ? rank - 1 : 0;
+        nth_element(waitMicros.begin(), waitMicros.begin() + index, waitMicros.end());
+        return waitMicros[index];
+    }
+};
+
+struct RunQueueStats
+{
+    size_t limit = 0;
+    array<RunClassStats, RUN_PRIORITY_COUNT> classes;
+
+    void print(ostream& out)
+    {
+        out << "Coada de rulare (limita " << limit << " pe clasa):\n";
+        for (size_t i = 0; i < RUN_PRIORITY_COUNT; ++i)
+        {
+            RunClassStats& stats = classes[i];
+            out << "  - " << runPriorityName(static_cast<RunPriority>(i)) << ": in asteptare " << stats.queued
+                << " (maxim " << stats.peakQueued << "), chiriasi " << stats.tenants << ", admise " << stats.admitted
+                << ", respinse " << stats.rejected << ", terminate " << stats.completed << ", asteptare (us) p50 "
+                << stats.waitPercentile(50) << ", p99 " << stats.waitPercentile(99) << "\n";
+        }
+    }
+};
+
+// Coada de rulare din fata worker-ilor: prioritate stricta intre clase, iar in interiorul unei clase impartire
+// echitabila intre chiriasi (clienti) dupa timpul de executie consumat, ponderat (start-time fair queuing). Un chirias
+// care trimite un lot urias nu ii infometeaza pe ceilalti: este servit chiriasul cu cel mai mic timp virtual, iar
+// timpul real al fiecarei sarcini ii este adaugat, impartit la pondere, dupa terminare. Admiterea este limitata
+// pe clasa. Nu este sincronizata: WorkerPool o foloseste sub blocarea proprie.
+class RunQueue
+{
+public:
+    struct Job
+    {
+        function<void()> task;
+        RunPriority priority;
+        string tenant;
+        chrono::steady_clock::time_point enqueued;
+    };
+
+private:
+    struct Tenant
+    {
+        deque<Job> jobs;
+        double virtualTime = 0;  // Microsecunde de executie / pondere
+        size_t running = 0;
+    };
+
+    struct PriorityClass
+    {
+        unordered_map<string, Tenant> tenants;
+        double virtualClock = 0;  // Timpul virtual al ultimului chirias servit
+        size_t purgeThreshold = 64;
+        size_t waitSampleIndex = 0;  // Urmatoarea pozitie suprascrisa in inelul stats.waitMicros al clasei
+        RunClassStats stats;
+    };
+
+    static const size_t WAIT_SAMPLES = 1024;
+
+    array<PriorityClass, RUN_PRIORITY_COUNT> classes;
+    unordered_map<string, double> weights;  // Implicit 1
+    size_t limit;
+
+    double weightOf(const string& tenant) const
+    {
+        auto found = weights.find(tenant);
+        return found != weights.end() ? found->second : 1.0;
+    }
+
+    // Un chirias fara sarcini si fara datorii (timpul lui virtual a fost ajuns de ceas) nu mai este pastrat
+    static bool isIdle(const PriorityClass& priorityClass, const Tenant& tenant)
+    {
+        return tenant.jobs.empty() && tenant.running == 0 && tenant.virtualTime <= priorityClass.virtualClock;
+    }
+
+    // Chiriasii care au ramas cu datorii cand au devenit inactivi (de exemplu conexiuni inchise) sunt eliminati
+    // dupa ce ceasul clasei ii ajunge; verificarea se face cand tabela chiriasilor s-a dublat
+    static void purgeIdle(PriorityClass& priorityClass)
+    {
+        for (auto it = priorityClass.tenants.begin(); it != priorityClass.tenants.end();)
+        {
+            it = isIdle(priorityClass, it->second) ? priorityClass.tenants.erase(it) : next(it);
+        }
+        priorityClass.purgeThreshold = max<size_t>(64, priorityClass.tenants.size() * 2);
+    }
+
+public:
+    RunQueue(size_t perClassLimit) : limit(perClassLimit) {}
+
+    void setLimit(size_t perClassLimit)
+    {
+        limit = perClassLimit;
+    }
+
+    void setTenantWeight(const string& tenant, double weight)
+    {
+        weights[tenant] = max(weight, 0.001);
+    }
+
+    // Intoarce false daca clasa este plina; force admite oricum (reincercarile unor rulari deja admise)
+    bool push(function<void()> task, RunPriority priority, const string& tenant, bool force)
+    {
+        PriorityClass& priorityClass = classes[static_cast<size_t>(priority)];
+        if (!force && priorityClass.stats.queued >= limit)
+        {
+            priorityClass.stats.rejected++;
+            return false;
+        }
+        if (priorityClass.tenants.size() >= priorityClass.purgeThreshold)
+        {
+            purgeIdle(priorityClass);
+        }
+        Tenant& entry = priorityClass.tenants[tenant];
+        if (entry.jobs.empty() && entry.running == 0)
+        {
+            // Un chirias care revine nu primeste credit pentru perioada in care nu a avut sarcini
+            entry.virtualTime = max(entry.virtualTime, priorityClass.virtualClock);
+        }
+        entry.jobs.push_back(Job{move(task), priority, tenant, chrono::steady_clock::now()});
+        priorityClass.stats.admitted++;
+        priorityClass.stats.queued++;
+        priorityClass.stats.peakQueued = max(priorityClass.stats.peakQueued, priorityClass.stats.queued);
+        return true;
+    }
+
+    bool empty() const
+    {
+        for (const PriorityClass& priorityClass : classes)
+        {
+            if (priorityClass.stats.queued > 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Urmatoarea sarcina: prima clasa nevida, chiriasul ei cu cel mai mic timp virtual; coada nu trebuie sa fie goala
+    Job pop()
+    {
+        for (PriorityClass& priorityClass : classes)
+        {
+            if (priorityClass.stats.queued == 0)
+            {
+                continue;
+            }
+            unordered_map<string, Tenant>::iterator chosen = priorityClass.tenants.end();
+            for (auto it = priorityClass.tenants.begin(); it != priorityClass.tenants.end(); ++it)
+            {
+                if (!it->second.jobs.empty() && (chosen == priorityClass.tenants.end() || it->second.virtualTime < chosen->second.virtualTime))
+                {
+                    chosen = it;
+                }
+            }
+            Job job = move(chosen->second.jobs.front());
+            chosen->second.jobs.pop_front();
+            chosen->second.running++;
+            priorityClass.virtualClock = max(priorityClass.virtualClock, chosen->second.virtualTime);
+            priorityClass.stats.queued--;
+
+            long long wait = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - job.enqueued).count();
+            vector<long long>& samples = priorityClass.stats.waitMicros;
+            if (samples.size() < WAIT_SAMPLES)
+            {
+                samples.push_back(wait);
+            }
+            else
+            {
+                samples[priorityClass.waitSampleIndex++ % WAIT_SAMPLES] = wait;
+            }
+            return job;
+        }
+        throw logic_error("Coada de rulare este goala");
+    }
+
+    // Timpul de executie al sarcinii este taxat chiriasului ei
+    void finished(RunPriority priority, const string& tenant, chrono::microseconds duration)
+    {
+        PriorityClass& priorityClass = classes[static_cast<size_t>(priority)];
+        priorityClass.stats.completed++;
+        auto found = priorityClass.tenants.find(tenant);
+        if (found == priorityClass.tenants.end())
+        {
+            return;
+        }
+        found->second.running--;
+        found->second.virtualTime += static_cast<double>(duration.count()) / weightOf(tenant);
+        if (isIdle(priorityClass, found->second))
+        {
+            priorityClass.tenants.erase(found);
+        }
+    }
+
+    RunQueueStats getStats() const
+    {
+        RunQueueStats stats;
+        stats.limit = limit;
+        for (size_t i = 0; i < RUN_PRIORITY_COUNT; ++i)
+        {
+            stats.classes[i] = classes[i].stats;
+            stats.classes[i].tenants = classes[i].tenants.size();
+        }
+        return stats;
+    }
+};
+
+
+// Set fix de thread-uri care executa sarcinile din coada de rulare
+class WorkerPool
+{
+private:
+    vector<thread> workers;
+    RunQueue queue;
+    mutable mutex queueMutex;
+    condition_variable queueReady;
+    bool stopping;
+
+    static const size_t DEFAULT_QUEUE_LIMIT = 4096;
+
+    void workerLoop()
+    {
+        while (true)
+        {
+            RunQueue::Job job;
+            {
+                unique_lock<mutex> guard(queueMutex);
+                queueReady.wait(guard, [this] { return stopping || !queue.empty(); });
+                if (queue.empty())
+                {
+                    return;
+                }
+                job = queue.pop();
+            }
+            chrono::steady_clock::time_point started = chrono::steady_clock::now();
+            // O sarcina care arunca nu trebuie sa opreasca thread-ul si nici sa ramana numarata ca in executie
+            try
+            {
+                job.task();
+            }
+            catch (const exception& e)
+            {
+                cerr << "Eroare in sarcina de rulare: " << e.what() << "\n";
+            }
+            catch (...)
+            {
+                cerr << "Eroare necunoscuta in sarcina de rulare\n";
+            }
+            chrono::microseconds duration = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started);
+            lock_guard<mutex> guard(queueMutex);
+            queue.finished(job.priority, job.tenant, duration);
+        }
+    }
+
+public:
+    WorkerPool(size_t threadCount, size_t queueLimit = DEFAULT_QUEUE_LIMIT) : queue(queueLimit), stopping(false)
+    {
+        for (size_t i = 0; i < max<size_t>(threadCount, 1); ++i)
+        {
+            workers.emplace_back(&WorkerPool::workerLoop, this);
+        }
+    }
+
+    // Intoarce false daca sarcina nu a fost admisa (clasa ei are coada plina)
+    bool submit(function<void()> task, RunPriority priority = RunPriority::Normal, const string& tenant = "", bool force = false)
+    {
+        {
+            lock_guard<mutex> guard(queueMutex);
+            if (stopping || !queue.push(move(task), priority, tenant, force))
+            {
+                return false;
+            }
+        }
+        queueReady.notify_one();
+        return true;
+    }
+
+    void setQueueLimit(size_t perClassLimit)
+    {
+        lock_guard<mutex> guard(queueMutex);
+        queue.setLimit(perClassLimit);
+    }
+
+    void setTenantWeight(const string& tenant, double weight)
+    {
+        lock_guard<mutex> guard(queueMutex);
+        queue.setTenantWeight(tenant, weight);
+    }
+
+    RunQueueStats getQueueStats() const
+    {
+        lock_guard<mutex> guard(queueMutex);
+        return queue.getStats();
+    }
+
+    // Sarcinile deja puse in coada sunt terminate inainte de oprire; dupa oprire nu mai este admisa nicio sarcina.
+    // Proprietarul o apeleaza inaintea eliberarii resurselor folosite de sarcini (descriptori, timere).
+    void shutdown()
+    {
+        {
+            lock_guard<mutex> guard(queueMutex);
+            stopping = true;
+        }
+        queueReady.notify_all();
+        for (thread& worker : workers)
+        {
+            if (worker.joinable())
+            {
+                worker.join();
+            }
+        }
+    }
+
+    ~WorkerPool()
+    {
+        shutdown();
+    }
+};
+
+
+// Roata de timere: fiecare programare este pusa in slotul tick-ului la care expira, iar un singur thread
+// avanseaza roata si preda callback-urile expirate mai departe. Asteptarea nu tine ocupat niciun worker.
+class TimerWheel
+{
+private:
+    struct Timer
+    {
+        uint64_t dueTick;
+        function<void()> callback;
+    };
+
+    vector<vector<Timer>> slots;
+    chrono::milliseconds tickLength;
+    uint64_t currentTick;
+    mutex wheelMutex;
+    condition_variable stopSignal;
+    bool stopping;
+    thread ticker;
+
+    void tickLoop()
+    {
+        chrono::steady_clock::time_point nextTick = chrono::steady_clock::now() + tickLength;
+        unique_lock<mutex> guard(wheelMutex);
+        while (!stopSignal.wait_until(guard, nextTick, [this] { return stopping; }))
+        {
+            nextTick += tickLength;
+            currentTick++;
+
+            // Timerele cu mai multe ture ramase raman in slot
+            vector<Timer>& slot = slots[currentTick % slots.size()];
+            vector<Timer> remaining;
+            vector<function<void()>> due;
+            for (Timer& timer : slot)
+            {
+                if (timer.dueTick <= currentTick)
+                {
+                    due.push_back(move(timer.callback));
+                }
+                else
+                {
+                    remaining.push_back(move(timer));
+                }
+            }
+            slot.swap(remaining);
+
+            guard.unlock();
+            for (function<void()>& callback : due)
+            {
+                callback();
+            }
+            guard.lock();
+        }
+    }
+
+public:
+    TimerWheel(size_t slotCount = 512, chrono::milliseconds tick = chrono::milliseconds(10))
+        : slots(slotCount), tickLength(tick), currentTick(0), stopping(false)
+    {
+        ticker = thread(&TimerWheel::tickLoop, this);
+    }
+
+    // Callback-ul ruleaza pe thread-ul rotii, deci trebuie sa fie scurt (de exemplu sa puna o sarcina in coada).
+    // Dupa oprire programarea este ignorata.
+    void schedule(chrono::milliseconds delay, function<void()> callback)
+    {
+        lock_guard<mutex> guard(wheelMutex);
+        if (stopping)
+        {
+            return;
+        }
+        long long ticks = max<long long>(1, (delay.count() + tickLength.count() - 1) / tickLength.count());
+        uint64_t dueTick = currentTick + static_cast<uint64_t>(ticks);
+        slots[dueTick % slots.size()].push_back(Timer{dueTick, move(callback)});
+    }
+
+    // Timerele care nu au expirat inca sunt abandonate
+    void stop()
+    {
+        {
+            lock_guard<mutex> guard(wheelMutex);
+            stopping = true;
+        }
+        stopSignal.notify_all();
+        if (ticker.joinable())
+        {
+            ticker.join();
+        }
     }
 
-    void markScreenError(int screenNumber)
+    ~TimerWheel()
     {
-        errorScreens.push_back(screenNumber);
-        totalErrors++;
+        stop();
+    }
+};
+
+
+// O rulare parcata in asteptarea unui raspuns: ocupa doar cadrele corutinelor si copia pasilor, nu un thread
+class SuspendedRun
+{
+private:
+    shared_ptr<Flow> flow;
+    StepContext context;
+    string error;
+    StepTask task;
+    mutex resumeMutex;
+
+public:
+    SuspendedRun(shared_ptr<Flow> f)
+        : flow(f), task(flow->runAsync(make_shared<const FlowVersion>(flow->copyVersion()), context, error)) {}
+
+    // Ruleaza pana la prima intrebare; intoarce ce s-a afisat intre timp. Ca la RUN, afisarea si fisierele
+    // pasilor nu trec prin destinatia globala, pe care worker-ii nu o pot folosi in paralel
+    string start()
+    {
+        lock_guard<mutex> guard(resumeMutex);
+        NullSink discardedOutput;
+        DiscardOutputStore discardedFiles;
+        OutputScope outputScope(discardedOutput, discardedFiles);
+        task.start();
+        return context.takeTranscript();
+    }
+
+    string answer(const string& text)
+    {
+        lock_guard<mutex> guard(resumeMutex);
+        if (!context.isWaiting())
+        {
+            throw runtime_error("Rularea nu asteapta niciun raspuns.");
+        }
+        NullSink discardedOutput;
+        DiscardOutputStore discardedFiles;
+        OutputScope outputScope(discardedOutput, discardedFiles);
+        context.answer(text);
+        return context.takeTranscript();
+    }
+
+    bool isFinished()
+    {
+        lock_guard<mutex> guard(resumeMutex);
+        return task.isDone();
+    }
+
+    string getError()
+    {
+        lock_guard<mutex> guard(resumeMutex);
+        return error;
+    }
+};
+
+// Server local pe un socket Unix pentru comenzile FlowManager.
+// Protocol: o comanda pe linie (CREATE, RUN, DELETE, ANALYZE <nume>, SEARCH <termeni, cu ghilimele pentru spatii>,
+// LIST, REPORT, MEMORY, SHUTDOWN);
+// fiecare raspuns este "OK <lungime>\n<continut>" sau "ERR <lungime>\n<mesaj>", in ordinea cererilor.
+// Un client poate trimite mai multe cereri fara sa astepte raspunsurile (pipelining).
+// START <nume> porneste o rulare suspendabila si intoarce "ASTEAPTA <id>" cu intrebarea; ANSWER <id> <raspuns>
+// o reia pana la urmatoarea intrebare sau pana la "TERMINAT <id>"; SESSIONS numara rularile care asteapta.
+// PRIORITY <interactive|normal|bulk> si TENANT <nume> stabilesc clasa si chiriasul loturilor conexiunii in coada
+// de rulare (implicit normal si un chirias propriu fiecarei conexiuni), incepand cu lotul care le contine;
+// QUEUE afiseaza metricile cozii. Un lot respins de admitere primeste cate o eroare pentru fiecare cerere.
+// RUN nu are consola: un pas care cere date esueaza imediat, iar procesele interactive se ruleaza cu START.
+class FlowServer
+{
+private:
+    struct Connection
+    {
+        int fd;
+        string input;  // Cel mult o linie incompleta de MAX_REQUEST_BYTES
+        bool skippingLine;  // Restul unei linii prea lungi este aruncat
+        string output;
+        deque<string> pending;  // Cereri primite care nu au fost inca trimise la worker-i
+        bool busy;  // Un lot de cereri al acestei conexiuni este in executie
+        bool peerClosed;  // Clientul a terminat de trimis; raspunsurile ramase se trimit inainte de inchidere
+        RunPriority priority;
+        string tenant;
+    };
+
+    struct Completion
+    {
+        uint64_t connectionId;
+        string responses;
+        bool shutdown;  // Lotul contine SHUTDOWN; bucla se opreste dupa ce trimite raspunsurile lui
+    };
+
+    static const size_t MAX_REQUEST_BYTES = 64 << 10;
+
+    FlowManager& manager;
+    string socketPath;
+    int listenFd;
+    int epollFd;
+    int wakeFd;  // eventfd prin care worker-ii anunta bucla ca au terminat un lot
+    uint64_t nextConnectionId;
+    unordered_map<uint64_t, Connection> connections;
+    unordered_map<int, uint64_t> connectionByFd;
+    mutex completionMutex;
+    vector<Completion> completions;
+    atomic<bool> running;
+    mutex sessionsMutex;
+    unordered_map<uint64_t, shared_ptr<SuspendedRun>> sessions;  // Rulari care asteapta raspunsuri, dupa id
+    uint64_t nextSessionId = 1;
+    WorkerPool workers;
+    TimerWheel retryTimers;  // Oprita explicit in destructor, inaintea worker-ilor
+
+    static string frame(bool ok, const string& payload)
+    {
+        return string(ok ? "OK " : "ERR ") + to_string(payload.size()) + "\n" + payload;
+    }
+
+    // Intrarea pasilor este inchisa, iar prompturile, afisarea si fisierele lor sunt aruncate: worker-ii nu
+    // impart destinatia globala (bufferul ei nu este sincronizat) si stdout-ul serverului ramane neatins
+    static RunOutcome runWithoutConsole(Flow& flow)
+    {
+        ClosedInputBuf closedInput;
+        istream input(&closedInput);
+        input.exceptions(ios::badbit);
+        ostream discardedPrompts(nullptr);
+        StepIOScope scope(input, discardedPrompts);
+        NullSink discardedOutput;
+        DiscardOutputStore discardedFiles;
+        OutputScope outputScope(discardedOutput, discardedFiles);
+        return flow.run();
+    }
+
+    // Starea rularii dupa un START sau ANSWER; rularile terminate sunt scoase din lista
+    string sessionReply(uint64_t id, SuspendedRun& run, const string& transcript)
+    {
+        if (!run.isFinished())
+        {
+            return frame(true, "ASTEAPTA " + to_string(id) + "\n" + transcript);
+        }
+        {
+            lock_guard<mutex> guard(sessionsMutex);
+            sessions.erase(id);
+        }
+        string error = run.getError();
+        return error.empty() ? frame(true, "TERMINAT " + to_string(id) + "\n" + transcript)
+                             : frame(false, "ESUAT " + to_string(id) + ": " + error + "\n" + transcript);
+    }
+
+    string handleRequest(const string& line, RunPriority priority, const string& tenant)
+    {
+        istringstream request(line);
+        string command, name;
+        request >> command >> name;
+
+        try
+        {
+            // Linia goala marcheaza o cerere prea lunga, taiata de readConnection
+            if (command.empty())
+            {
+                return frame(false, "Cererea depaseste " + to_string(MAX_REQUEST_BYTES) + " octeti si a fost ignorata.");
+            }
+            // Aplicate deja de dispatch, pentru lotul care le contine
+            if (command == "PRIORITY")
+            {
+                RunPriority parsed;
+                return parseRunPriority(name, parsed) ? frame(true, "") : frame(false, "Clasa de prioritate necunoscuta: " + name);
+            }
+            if (command == "TENANT")
+            {
+                return name.empty() ? frame(false, "Lipseste numele chiriasului.") : frame(true, "");
+            }
+            if (command == "QUEUE")
+            {
+                ostringstream report;
+                workers.getQueueStats().print(report);
+                return frame(true, report.str());
+            }
+            if (command == "SEARCH")
+            {
+                // Aceeasi sintaxa ca in meniu: type:"display step" este un singur termen
+                vector<string> terms = StepIndex::parseQuery(line.substr(line.find("SEARCH") + 6));
+                string names;
+                for (const string& flowName : manager.searchFlows(terms))
+                {
+                    names += flowName + "\n";
+                }
+                return frame(true, names);
+            }
+            if (command == "REPORT")
+            {
+                ostringstream report;
+                manager.analyzeAll().print(report);
+                return frame(true, report.str());
+            }
+            if (command == "LIST")
+            {
+                string names;
+                for (const string& flowName : manager.getFlowNames())
+                {
+                    names += flowName + "\n";
+                }
+                return frame(true, names);
+            }
+            if (command == "MEMORY")
+            {
+                ostringstream report;
+                manager.memoryReport().print(report);
+                return frame(true, report.str());
+            }
+            if (command == "SESSIONS")
+            {
+                lock_guard<mutex> guard(sessionsMutex);
+                return frame(true, to_string(sessions.size()) + "\n");
+            }
+            if (command == "ANSWER")
+            {
+                // ANSWER <id> <raspuns>: restul liniei, poate contine spatii sau poate fi gol
+                string text;
+                getline(request, text);
+                if (!text.empty() && text[0] == ' ')
+                {
+                    text.erase(0, 1);
+                }
+                uint64_t id = strtoull(name.c_str(), nullptr, 10);
+                shared_ptr<SuspendedRun> run;
+                {
+                    lock_guard<mutex> guard(sessionsMutex);
+                    auto found = sessions.find(id);
+                    if (found != sessions.end())
+                    {
+                        run = found->second;
+                    }
+                }
+                if (!run)
+                {
+                    return frame(false, "Rularea " + name + " nu exista.");
+                }
+                string transcript = run->answer(text);
+                return sessionReply(id, *run, transcript);
+            }
+            if (command == "SHUTDOWN")
+            {
+                return frame(true, "");  // Bucla se opreste in collectCompletions, dupa ce trimite lotul
+            }
+            if (command != "CREATE" && command != "DELETE" && command != "RUN" && command != "START" && command != "ANALYZE")
+            {
+                return frame(false, "Comanda necunoscuta: " + command);
+            }
+            if (name.empty())
+            {
+                return frame(false, "Lipseste numele procesului.");
+            }
+            if (command == "CREATE")
+            {
+                manager.createFlow(name);
+                return frame(true, "");
+            }
+            if (command == "DELETE")
+            {
+                return manager.deleteFlow(name) ? frame(true, "") : frame(false, "Procesul " + name + " nu exista.");
+            }
+
+            shared_ptr<Flow> flow = manager.getFlowByName(name);
+            if (!flow)
+            {
+                return frame(false, "Procesul " + name + " nu exista.");
+            }
+            if (command == "RUN")
+            {
+                RunOutcome outcome = runWithoutConsole(*flow);
+                manager.reindexFlow(*flow);
+                manager.enforceMemoryBudget();
+                if (outcome.status == RunStatus::RetryScheduled)
+                {
+                    scheduleRetry(flow, outcome.retryDelay, priority, tenant);
+                    return frame(true, "Reincercare programata in " + to_string(outcome.retryDelay.count()) + " ms: " + outcome.error);
+                }
+                return outcome.status == RunStatus::Completed ? frame(true, "") : frame(false, outcome.error);
+            }
+            if (command == "START")
+            {
+                shared_ptr<SuspendedRun> run = make_shared<SuspendedRun>(flow);
+                uint64_t id;
+                {
+                    lock_guard<mutex> guard(sessionsMutex);
+                    id = nextSessionId++;
+                    sessions[id] = run;
+                }
+                string transcript = run->start();
+                return sessionReply(id, *run, transcript);
+            }
+            if (command == "ANALYZE")
+            {
+                ostringstream report;
+                manager.analyzeFlow(flow.get(), report);
+                return frame(true, report.str());
+            }
+            return frame(false, "Comanda necunoscuta: " + command);
+        }
+        catch (const exception& e)
+        {
+            return frame(false, e.what());
+        }
+    }
+
+    // Reincercarea asteapta in roata de timere, nu intr-un worker; rularea a fost deja admisa, deci intra in coada
+    // chiar daca aceasta este plina, in clasa si pentru chiriasul cererii initiale
+    void scheduleRetry(shared_ptr<Flow> flow, chrono::milliseconds delay, RunPriority priority, const string& tenant)
+    {
+        retryTimers.schedule(delay, [this, flow, priority, tenant]()
+        {
+            workers.submit([this, flow, priority, tenant]()
+            {
+                RunOutcome outcome = runWithoutConsole(*flow);
+                manager.reindexFlow(*flow);
+                if (outcome.status == RunStatus::RetryScheduled)
+                {
+                    scheduleRetry(flow, outcome.retryDelay, priority, tenant);
+                }
+            }, priority, tenant, true);
+        });
+    }
+
+    void addToEpoll(int fd, uint32_t events)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void closeConnection(uint64_t id)
+    {
+        auto found = connections.find(id);
+        if (found == connections.end())
+        {
+            return;
+        }
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, found->second.fd, nullptr);
+        ::close(found->second.fd);
+        connectionByFd.erase(found->second.fd);
+        connections.erase(found);
+    }
+
+    void acceptConnections()
+    {
+        while (true)
+        {
+            int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientFd < 0)
+            {
+                return;
+            }
+            uint64_t id = nextConnectionId++;
+            connections[id] = Connection{clientFd, "", false, "", {}, false, false, RunPriority::Normal, "#" + to_string(id)};
+            connectionByFd[clientFd] = id;
+            addToEpoll(clientFd, EPOLLIN | EPOLLRDHUP);
+        }
+    }
+
+    // Toate cererile primite sunt trimise ca un singur lot, astfel incat raspunsurile raman in ordine
+    void dispatch(uint64_t id, Connection& connection)
+    {
+        if (connection.busy || connection.pending.empty())
+        {
+            return;
+        }
+        vector<string> batch(connection.pending.begin(), connection.pending.end());
+        connection.pending.clear();
+        for (const string& line : batch)
+        {
+            istringstream request(line);
+            string command, value;
+            request >> command >> value;
+            if (command == "PRIORITY")
+            {
+                parseRunPriority(value, connection.priority);
+            }
+            else if (command == "TENANT" && !value.empty())
+            {
+                connection.tenant = value;
+            }
+        }
+
+        RunPriority priority = connection.priority;
+        string tenant = connection.tenant;
+        bool admitted = workers.submit([this, id, batch, priority, tenant]()
+        {
+            string responses;
+            bool shutdown = false;
+            for (const string& line : batch)
+            {
+                responses += handleRequest(line, priority, tenant);
+                string command;
+                istringstream(line) >> command;
+                shutdown = shutdown || command == "SHUTDOWN";
+            }
+            {
+                lock_guard<mutex> guard(completionMutex);
+                completions.push_back(Completion{id, move(responses), shutdown});
+            }
+            uint64_t one = 1;
+            ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+            (void)ignored;
+        }, priority, tenant);
+        if (!admitted)
+        {
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                connection.output += frame(false, string("Coada de rulare pentru clasa ") + runPriorityName(priority) + " este plina.");
+            }
+            return;
+        }
+        connection.busy = true;
+    }
+
+    // Intoarce false daca conexiunea a fost inchisa
+    bool flushOutput(uint64_t id, Connection& connection)
+    {
+        while (!connection.output.empty())
+        {
+            ssize_t written = ::send(connection.fd, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+            if (written < 0)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    break;
+                }
+                closeConnection(id);
+                return false;
+            }
+            connection.output.erase(0, static_cast<size_t>(written));
+        }
+
+        if (connection.peerClosed && !connection.busy && connection.pending.empty() && connection.output.empty())
+        {
+            closeConnection(id);
+            return false;
+        }
+
+        epoll_event event{};
+        event.events = (connection.peerClosed ? 0u : static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP)) | (connection.output.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+        event.data.fd = connection.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        return true;
+    }
+
+    // Muta liniile complete in pending. O linie peste MAX_REQUEST_BYTES primeste o eroare in ordinea cererilor,
+    // iar restul ei este aruncat pe masura ce soseste, pana la urmatorul '\n'.
+    void takeLines(Connection& connection)
+    {
+        size_t lineEnd;
+        while (connection.skippingLine)
+        {
+            lineEnd = connection.input.find('\n');
+            if (lineEnd == string::npos)
+            {
+                connection.input.clear();
+                return;
+            }
+            connection.input.erase(0, lineEnd + 1);
+            connection.skippingLine = false;
+        }
+        while ((lineEnd = connection.input.find('\n')) != string::npos)
+        {
+            string line = connection.input.substr(0, lineEnd);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            connection.input.erase(0, lineEnd + 1);
+            if (!line.empty())
+            {
+                connection.pending.push_back(line);
+            }
+        }
+        if (connection.input.size() > MAX_REQUEST_BYTES)
+        {
+            connection.input.clear();
+            connection.pending.push_back("");
+            connection.skippingLine = true;
+        }
+    }
+
+    void readConnection(uint64_t id, Connection& connection)
+    {
+        char buffer[4096];
+        while (true)
+        {
+            ssize_t received = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (received == 0)
+            {
+                connection.peerClosed = true;
+                break;
+            }
+            if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                closeConnection(id);
+                return;
+            }
+            if (received < 0)
+            {
+                break;
+            }
+            connection.input.append(buffer, static_cast<size_t>(received));
+            takeLines(connection);
+        }
+        dispatch(id, connection);
+        flushOutput(id, connection);
+    }
+
+    void collectCompletions()
+    {
+        uint64_t counter;
+        ssize_t ignored = ::read(wakeFd, &counter, sizeof(counter));
+        (void)ignored;
+
+        vector<Completion> finished;
+        {
+            lock_guard<mutex> guard(completionMutex);
+            finished.swap(completions);
+        }
+        for (Completion& completion : finished)
+        {
+            auto found = connections.find(completion.connectionId);
+            if (found == connections.end())
+            {
+                continue;  // Clientul s-a deconectat intre timp
+            }
+            Connection& connection = found->second;
+            connection.busy = false;
+            connection.output += completion.responses;
+            if (completion.shutdown)
+            {
+                running = false;
+            }
+            if (flushOutput(completion.connectionId, connection))
+            {
+                dispatch(completion.connectionId, connection);
+                if (!connection.busy && !connection.output.empty())
+                {
+                    flushOutput(completion.connectionId, connection);  // Lotul respins de coada
+                }
+            }
+        }
+    }
+
+    // La oprire, socket-urile neblocante pot refuza o parte din raspunsuri; clientii au cel mult o secunda sa le citeasca
+    void drainOutput()
+    {
+        chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(1);
+        while (chrono::steady_clock::now() < deadline)
+        {
+            vector<uint64_t> waiting;
+            for (const auto& entry : connections)
+            {
+                if (!entry.second.output.empty())
+                {
+                    waiting.push_back(entry.first);
+                }
+            }
+            if (waiting.empty())
+            {
+                return;
+            }
+            for (uint64_t id : waiting)
+            {
+                auto found = connections.find(id);
+                if (found != connections.end())
+                {
+                    flushOutput(id, found->second);
+                }
+            }
+            epoll_event events[64];
+            epoll_wait(epollFd, events, 64, 50);
+        }
+    }
+
+public:
+    FlowServer(FlowManager& m, const string& path, size_t workerCount, size_t queueLimit)
+        : manager(m), socketPath(path), listenFd(-1), epollFd(-1), wakeFd(-1), nextConnectionId(1),
+          running(false), workers(workerCount, queueLimit) {}
+
+    void setTenantWeight(const string& tenant, double weight)
+    {
+        workers.setTenantWeight(tenant, weight);
     }
 
-    bool isCompletedSuccessfully() const
-    {
-        return isCompleted;
+    void serve()
+    {
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0)
+        {
+            throw runtime_error("Eroare la crearea socket-ului.");
+        }
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(address.sun_path))
+        {
+            throw runtime_error("Calea socket-ului este prea lunga: " + socketPath);
+        }
+        strcpy(address.sun_path, socketPath.c_str());
+        unlink(socketPath.c_str());
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listenFd, SOMAXCONN) < 0)
+        {
+            throw runtime_error("Eroare la deschiderea socket-ului " + socketPath);
+        }
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        addToEpoll(listenFd, EPOLLIN);
+        addToEpoll(wakeFd, EPOLLIN);
+
+        cout << "Serverul asculta pe " << socketPath << "\n";
+        cout.flush();
+
+        running = true;
+        epoll_event events[64];
+        while (running)
+        {
+            int ready = epoll_wait(epollFd, events, 64, 200);
+            for (int i = 0; i < ready; ++i)
+            {
+                int fd = events[i].data.fd;
+                if (fd == listenFd)
+                {
+                    acceptConnections();
+                    continue;
+                }
+                if (fd == wakeFd)
+                {
+                    collectCompletions();
+                    continue;
+                }
+
+                auto byFd = connectionByFd.find(fd);
+                if (byFd == connectionByFd.end())
+                {
+                    continue;
+                }
+                uint64_t id = byFd->second;
+                Connection& connection = connections[id];
+                if (events[i].events & EPOLLOUT)
+                {
+                    if (!flushOutput(id, connection))
+                    {
+                        continue;
+                    }
+                }
+                if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                {
+                    readConnection(id, connection);
+                }
+            }
+        }
+
+        // Trimitem raspunsurile ramase (inclusiv cel pentru SHUTDOWN) inainte de inchidere
+        drainOutput();
     }
 
-    ~Flow()
+    ~FlowServer()
     {
-        for (Step* step : steps)
+        // Roata se opreste prima, ca sa nu mai puna reincercari in coada; sarcinile ramase in coada o pot apela
+        // (programarea este ignorata) si scriu in wakeFd, deci worker-ii se opresc inainte de inchiderea descriptorilor
+        retryTimers.stop();
+        workers.shutdown();
+        for (auto& entry : connections)
+        {
+            ::close(entry.second.fd);
+        }
+        if (listenFd >= 0)
+        {
+            ::close(listenFd);
+            unlink(socketPath.c_str());
+        }
+        if (epollFd >= 0)
         {
-            delete step;
+            ::close(epollFd);
+        }
+        if (wakeFd >= 0)
+        {
+            ::close(wakeFd);
         }
-        steps.clear();
     }
+};
 
-    string getName() const
+// Pasii de calcul ai builder-ului, in tipul numeric ales pentru proces
+template<typename T>
+Step* createCalculusStep(Flow* flow, int steps, const string& operation)
+{
+    CalculusStepT<T>* calculusStep = new CalculusStepT<T>(steps, operation);
+
+    // Adăugăm input-uri pentru CalculusStep
+    for (int i = 0; i < steps; ++i)
     {
-        return name;
+        cout << "Adaugati input pentru pasul " << i + 1 << "\n";
+        NumberInputStepT<T>* inputStep = new NumberInputStepT<T>("Descriere");
+        flowManager.addStepToFlow(flow, inputStep);
+        calculusStep->addInputStep(inputStep);
+        // Nu este necesar să rulezi flow-ul aici
     }
+    return calculusStep;
+}
 
-   string getStepsInfo() const
+Step* createCalculusStep(NumericMode mode, Flow* flow, int steps, const string& operation)
 {
-    string stepsInfo;
-    for (const Step* step : steps)
+    switch (mode)
     {
-        stepsInfo += step->getDescription() + " | ";
+    case NumericMode::Double:
+        return createCalculusStep<double>(flow, steps, operation);
+    case NumericMode::Decimal:
+        return createCalculusStep<FixedDecimal>(flow, steps, operation);
+    default:
+        return createCalculusStep<float>(flow, steps, operation);
     }
-    return stepsInfo;
 }
 
-
+// Import in masa al proceselor dintr-un fisier CSV in formatul FlowDefinitionCodec
+struct ImportResult
+{
+    size_t flowCount = 0;
+    size_t stepCount = 0;
+    vector<string> errors;
 };
 
-class FlowManager
+class FlowImporter
 {
 private:
-    vector<Flow*> flows;
+    typedef FlowDefinitionCodec::Row Row;
 
-public:
-    const vector<Flow*>& getFlows() const
+    struct FlowDefinition
     {
-        return flows;
-    }
+        string name;
+        vector<const Row*> rows;
+    };
 
-    void createFlow(const string& name)
-    {
-        Flow* newFlow = new Flow(name);
-        flows.push_back(newFlow);
-    }
+    FlowManager& manager;
+    size_t threadCount;
 
-    void displayAvailableSteps()
+    // Ruleaza work(i, t) pentru i in [0, count), impartit in intervale egale pe thread-uri
+    template<typename Work>
+    void parallelFor(size_t count, Work work) const
     {
-        cout << "Available steps:\n";
-        cout << "1. Title Step\n";
-        cout << "2. Text Step\n";
-        cout << "3. Text Input Step\n";
-        cout << "4. Number Input Step\n";
-        cout << "5. Calculus Step\n";
-        cout << "6. Display Step\n";
-        cout << "7. Text File Input Step\n";
-        cout << "8. CSV File Input Step\n";
-        cout << "9. Output Step\n";
-        cout << "10. End Step\n";
+        size_t threads = max<size_t>(1, min(threadCount, count));
+        size_t chunkSize = (count + threads - 1) / threads;
+        vector<thread> workers;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&, t]()
+            {
+                size_t end = min(count, (t + 1) * chunkSize);
+                for (size_t i = t * chunkSize; i < end; ++i)
+                {
+                    work(i, t);
+                }
+            });
+        }
+        for (thread& worker : workers)
+        {
+            worker.join();
+        }
     }
 
-    void addStepToFlow(Flow* flow, Step* step)
+public:
+    FlowImporter(FlowManager& m, size_t threads = thread::hardware_concurrency())
+        : manager(m), threadCount(max<size_t>(1, threads)) {}
+
+    // Importul este tot-sau-nimic: procesele sunt inregistrate doar daca intreg fisierul este valid
+    ImportResult importFile(const string& path)
     {
+        ImportResult result;
+        ifstream input(path, ios::binary);
+        if (!input.is_open())
+        {
+            result.errors.push_back("Eroare la deschiderea fisierului " + path);
+            return result;
+        }
+        string data((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
 
-        flow->addStep(step);
-        if (!flow->isCompletedSuccessfully())
+        vector<pair<size_t, size_t>> lines;  // Inceputul si lungimea fiecarei linii
+        for (size_t start = 0; start < data.size();)
         {
-            step->execute();
+            size_t end = data.find('\n', start);
+            end = end == string::npos ? data.size() : end;
+            lines.emplace_back(start, end - start);
+            start = end + 1;
         }
-    }
 
-    void runFlow(Flow* flow)
-    {
-        flow->run();
-    }
+        // Liniile sunt despartite in campuri in paralel
+        vector<Row> rows(lines.size());
+        parallelFor(lines.size(), [&](size_t i, size_t)
+        {
+            string line = data.substr(lines[i].first, lines[i].second);
+            rows[i].lineNumber = i + 1;
+            if (line.find_first_not_of(" \t\r") != string::npos && line[line.find_first_not_of(" \t")] != '#')
+            {
+                rows[i].fields = FlowDefinitionCodec::splitCsvLine(line);
+            }
+        });
 
-    void deleteFlow(Flow* flow)
-    {
-        auto it = find(flows.begin(), flows.end(), flow);
-        if (it != flows.end())
+        // Gruparea pe procese pastreaza ordinea aparitiei
+        vector<FlowDefinition> definitions;
+        unordered_map<string, size_t> definitionByName;
+        for (const Row& row : rows)
         {
-            flows.erase(it);
-            delete flow;
+            if (row.fields.empty())
+            {
+                continue;
+            }
+            if (row.fields.size() < 2 || row.fields[0].empty())
+            {
+                result.errors.push_back("linia " + to_string(row.lineNumber) + ": lipseste numele procesului sau tipul pasului");
+                continue;
+            }
+            auto found = definitionByName.emplace(row.fields[0], definitions.size());
+            if (found.second)
+            {
+                definitions.push_back(FlowDefinition{row.fields[0], {}});
+            }
+            definitions[found.first->second].rows.push_back(&row);
         }
-    }
 
-    Flow* getFlowByName(const string& name)
-    {
-        auto it = find_if(flows.begin(), flows.end(),
-                          [name](const Flow* flow)
+        // Procesele sunt construite si validate in paralel
+        vector<shared_ptr<Flow>> flows(definitions.size());
+        vector<vector<string>> errorsByThread(threadCount);
+        parallelFor(definitions.size(), [&](size_t i, size_t t)
         {
-            return flow->getName() == name;
+            flows[i] = FlowDefinitionCodec::build(definitions[i].name, definitions[i].rows, errorsByThread[t]);
         });
+        for (const vector<string>& errors : errorsByThread)
+        {
+            result.errors.insert(result.errors.end(), errors.begin(), errors.end());
+        }
+        if (!result.errors.empty())
+        {
+            return result;
+        }
 
-        return (it != flows.end()) ? *it : nullptr;
-    }
+        manager.addFlows(flows);
+        result.flowCount = flows.size();
+        for (const shared_ptr<Flow>& flow : flows)
+        {
+            result.stepCount += flow->getSteps().size();
+        }
 
-    void analyzeFlow(Flow* flow) const
-    {
-        flow->analyze();
+        // Procesele importate pot fi evacuate doar dupa ce importul nu mai tine referinte la ele
+        flows.clear();
+        manager.enforceMemoryBudget(true);
+        return result;
     }
+};
 
-    ~FlowManager()
+// Afiseaza rezultatul importului si salveaza catalogul o singura data
+bool reportImport(const ImportResult& result, const string& catalogFile)
+{
+    if (!result.errors.empty())
     {
-        for (Flow* flow : flows)
+        cout << "Importul a esuat, niciun proces nu a fost adaugat (" << result.errors.size() << " erori):\n";
+        for (size_t i = 0; i < result.errors.size() && i < 20; ++i)
         {
-            delete flow;
+            cout << "  - " << result.errors[i] << "\n";
         }
-        flows.clear();
+        return false;
     }
+    flowManager.saveFlowsToFile(catalogFile);
+    cout << "Au fost importate " << result.flowCount << " procese cu " << result.stepCount << " pasi.\n";
+    return true;
+}
 
-    void addFlow(Flow* flow)
+// Scrie cronologia inregistrata de --trace-out
+void exportExecutionTrace(const string& fileName)
 {
-    flows.push_back(flow);
+    if (!executionTracer)
+    {
+        return;
+    }
+    long long exported = executionTracer->exportChromeTrace(fileName);
+    if (exported < 0)
+    {
+        cerr << "Eroare la scrierea cronologiei in " << fileName << "\n";
+        return;
+    }
+    cout << "Cronologia (" << exported << " evenimente) a fost scrisa in " << fileName << "\n";
 }
 
-    void saveFlowsToFile(const string& filename) const
+int main(int argc, char* argv[])
+{
+    // cout nu mai este sincronizat cu stdio; cin ramane legat de cout pentru prompturi
+    ios::sync_with_stdio(false);
+
+    // Destinatia afisarii se construieste o singura data, dupa toate optiunile, deci ordinea lor nu conteaza
+    size_t outputBufferSize = FdSink::DEFAULT_BUFFER_SIZE;
+    bool quietOutput = false;
+    string outputFile;
+    size_t memoryBudget = 0;
+    size_t flowBudget = 0;
+    string evictDirectory = ".";
+    string traceOutFile;
+    size_t queueLimit = 4096;
+    vector<pair<string, double>> tenantWeights;
+    size_t serverWorkers = thread::hardware_concurrency();
+    string serverSocket;
+    string catalogFile = "procese.txt";
+    string importFile;
+    for (int i = 1; i < argc; ++i)
     {
-        ofstream outputFile(filename);
-
-        if (!outputFile.is_open())
+        string argument = argv[i];
+        if (argument == "--self-test")
         {
-            cerr << "Eroare la deschiderea fisierului " << filename << endl;
-            return;
+            // Verifica formatul comprimat al cataloagelor si jurnalelor, fara sa porneasca aplicatia
+            cout << "Verificarea formatului comprimat:\n";
+            int failures = selfTestCompression(cout);
+            cout << (failures == 0 ? "Toate verificarile au trecut." : to_string(failures) + " verificari au esuat.") << "\n";
+            return failures == 0 ? 0 : 1;
         }
-
-        for (const Flow* flow : flows)
+        else if (argument == "--buffer" && i + 1 < argc)
         {
-            outputFile << "Numele procesului: " << flow->getName() << "\n";
-
-            // Adăugați detaliile fiecărui pas în fișier
-            for (const Step* step : flow->getSteps())
+            outputBufferSize = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--quiet")
+        {
+            // Modul batch: continutul afisat de pasi nu mai ajunge in consola
+            quietOutput = true;
+            outputFile.clear();
+        }
+        else if (argument == "--output" && i + 1 < argc)
+        {
+            outputFile = argv[++i];
+            quietOutput = false;
+        }
+        else if (argument == "--workers" && i + 1 < argc)
+        {
+            serverWorkers = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--server" && i + 1 < argc)
+        {
+            serverSocket = argv[++i];
+        }
+        else if (argument == "--catalog" && i + 1 < argc)
+        {
+            // Un catalog cu extensia .flz este pastrat comprimat pe blocuri
+            catalogFile = argv[++i];
+        }
+        else if (argument == "--journal" && i + 1 < argc)
+        {
+            try
             {
-                step->writeDetailsToFile(outputFile);
+                runJournal.reset(new RunJournal(argv[++i]));
+            }
+            catch (const runtime_error& e)
+            {
+                cerr << "Eroare: " << e.what() << "\n";
+                return 1;
             }
-
-            outputFile << "-------------------------\n";
         }
-
-        outputFile.close();
+        else if (argument == "--import" && i + 1 < argc)
+        {
+            importFile = argv[++i];
+        }
+        else if (argument == "--output-store" && i + 1 < argc)
+        {
+            // Fisierele pasilor OUTPUT pot fi grupate in segmente, intr-o arhiva sau scrise prin descriptori refolositi
+            try
+            {
+                outputFileStore.reset(createOutputStore(argv[++i]));
+            }
+            catch (const runtime_error& e)
+            {
+                cerr << "Eroare: " << e.what() << "\n";
+                return 1;
+            }
+        }
+        else if (argument == "--record" && i + 1 < argc)
+        {
+            // Fiecare rulare din consola este adaugata ca urma rejucabila
+            traceLog.reset(new TraceLog(argv[++i]));
+        }
+        else if (argument == "--memo" && i + 1 < argc)
+        {
+            // Activeaza memorarea rezultatelor pasilor deterministi, cu o limita in octeti
+            resultCache.enable(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--memo-dir" && i + 1 < argc)
+        {
+            // Intrarile eliminate din memorie sunt pastrate in acest director
+            resultCache.enableSpill(argv[++i]);
+        }
+        else if (argument == "--memory-budget" && i + 1 < argc)
+        {
+            // Memoria totala a proceselor si a cache-ului, in octeti; procesele nefolosite sunt evacuate pe disc
+            memoryBudget = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--flow-budget" && i + 1 < argc)
+        {
+            // Memoria unui singur proces, in octeti
+            flowBudget = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--evict-dir" && i + 1 < argc)
+        {
+            evictDirectory = argv[++i];
+        }
+        else if (argument == "--checkpoint-dir" && i + 1 < argc)
+        {
+            // Pozitia rularilor este salvata dupa fiecare pas, ca o rulare intrerupta sa poata fi reluata
+            checkpointDirectory = argv[++i];
+        }
+        else if (argument == "--queue-limit" && i + 1 < argc)
+        {
+            // Cererile in asteptare admise pentru fiecare clasa de prioritate a serverului
+            queueLimit = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--tenant-weight" && i + 1 < argc)
+        {
+            // <chirias>=<pondere>: un chirias cu pondere 2 primeste de doua ori mai mult timp de executie in clasa lui
+            string weight = argv[++i];
+            size_t separator = weight.rfind('=');
+            if (separator == string::npos || separator == 0)
+            {
+                cerr << "Eroare: --tenant-weight asteapta <chirias>=<pondere>\n";
+                return 1;
+            }
+            tenantWeights.emplace_back(weight.substr(0, separator), strtod(weight.c_str() + separator + 1, nullptr));
+        }
+        else if (argument == "--trace-out" && i + 1 < argc)
+        {
+            // Cronologia pasilor este exportata la iesire (si din meniu) in formatul Chrome trace
+            traceOutFile = argv[++i];
+            executionTracer.reset(new ExecutionTracer());
+        }
     }
-
-
-    void displayFlowsFromFile(const string& filename) const
+    try
     {
-        ifstream inputFile(filename);
-
-        if (!inputFile.is_open())
+        if (quietOutput)
         {
-            cerr << "Eroare la deschiderea fisierului " << filename << endl;
-            return;
+            setOutputSink(new NullSink());
         }
-
-        string line;
-        while (getline(inputFile, line))
+        else if (!outputFile.empty())
         {
-            cout << line << endl;
+            setOutputSink(FdSink::openFile(outputFile, outputBufferSize));
+        }
+        else if (outputBufferSize != FdSink::DEFAULT_BUFFER_SIZE)
+        {
+            setOutputSink(new FdSink(STDOUT_FILENO, false, outputBufferSize));
         }
-
-        inputFile.close();
     }
-
-
-
-
-};
-
-
-
-// Clasa pentru pasul de tip final
-class EndStep : public Step
-{
-public:
-    void execute() override
+    catch (const runtime_error& e)
     {
-        cout << "Sfarsitul procesului. Procesul a fost completat cu succes." << endl;
+        cerr << "Eroare: " << e.what() << "\n";
+        return 1;
     }
-};
-
+    flowManager.setMemoryBudget(memoryBudget, flowBudget, evictDirectory);
 
+    // Procesele importate sunt disponibile atat in consola, cat si in modul server
+    if (!importFile.empty() && !reportImport(FlowImporter(flowManager).importFile(importFile), catalogFile))
+    {
+        return 1;
+    }
 
-FlowManager flowManager;
-
-int main()
-{
+    if (!serverSocket.empty())
+    {
+        try
+        {
+            FlowServer server(flowManager, serverSocket, serverWorkers, queueLimit);
+            for (const pair<string, double>& tenantWeight : tenantWeights)
+            {
+                server.setTenantWeight(tenantWeight.first, tenantWeight.second);
+            }
+            server.serve();
+        }
+        catch (const exception& e)
+        {
+            cerr << "Eroare: " << e.what() << "\n";
+            return 1;
+        }
+        exportExecutionTrace(traceOutFile);
+        return 0;
+    }
 
         vector<shared_ptr<Step>> steps;
 
-    cout << "---------------------------------------" << endl;
-    cout << "           BINE ATI VENIT!             " << endl;
-    cout << "---------------------------------------" << endl;
+    cout << "---------------------------------------" << "\n";
+    cout << "           BINE ATI VENIT!             " << "\n";
+    cout << "---------------------------------------" << "\n";
 
 
     int option;
@@ -854,7 +8432,13 @@ int main()
 
     try
     {
-        ofstream outputFile("procese.txt", ios::app);  // Deschide fisierul o singura data pentru adaugarea pasilor.
+        // Deschide fisierul o singura data pentru adaugarea pasilor; un catalog comprimat este scris doar de saveFlowsToFile
+        bool compressedCatalog = FlowManager::isCompressedCatalog(catalogFile);
+        ofstream outputFile;
+        if (!compressedCatalog)
+        {
+            outputFile.open(catalogFile, ios::app);
+        }
 
         while (true)
         {
@@ -865,6 +8449,14 @@ int main()
             cout << "4. Stergeti un proces\n";
             cout << "5. Afisati detalii despre un proces\n";
             cout << "6. Analizati un proces\n";
+            cout << "7. Adaugati un salt conditionat intre pasi\n";
+            cout << "8. Setati politica de reincercare a unui pas\n";
+            cout << "9. Analizati toate procesele\n";
+            cout << "10. Cautati procese dupa pasi (ex: file:lectie.csv type:\"display step\" cuvant)\n";
+            cout << "11. Test de incarcare (rejucarea unor urme sau urme sintetice)\n";
+            cout << "12. Importati procese dintr-un fisier CSV\n";
+            cout << "13. Raport de memorie\n";
+            cout << "14. Exportati cronologia pasilor (--trace-out)\n";
             cout << "0. Iesire\n";
             cout << "Optiune: ";
             cin >> option;
@@ -875,6 +8467,7 @@ int main()
             case 0:
                 {
                     cout << "La revedere!\n";
+                    exportExecutionTrace(traceOutFile);
                     return 0;
                 }
             case 1:
@@ -888,8 +8481,14 @@ int main()
 
 
 
-                    Flow* newFlow = new Flow(flowName);
-                    flowManager.createFlow(flowName);
+                    // Adăugăm procesul în manager încă de la creare, ca pașii adăugați să fie vizibili imediat
+                    shared_ptr<Flow> newFlow = flowManager.createFlow(flowName);
+
+                    int precision;
+                    cout << "Alegeti precizia numerica (1 - float, 2 - double, 3 - zecimal fix cu 4 zecimale): ";
+                    cin >> precision;
+                    newFlow->setNumericMode(precision == 2 ? NumericMode::Double
+                                            : precision == 3 ? NumericMode::Decimal : NumericMode::Float);
                     flowManager.displayAvailableSteps();
 
                     int stepOption;
@@ -903,10 +8502,13 @@ int main()
                         {
 
                             // Adăugarea informațiilor despre pași în fișier la finalizarea procesului
-                            ofstream outputFile("procese.txt", ios::app);
-                            outputFile << newFlow->getName() << " - " << newFlow->getStepsInfo() << "\n";
-                            outputFile << endl;  // Adauga un newline dupa terminarea pasilor
-                            outputFile.close();
+                            if (!compressedCatalog)
+                            {
+                                ofstream outputFile(catalogFile, ios::app);
+                                outputFile << newFlow->getName() << " - " << newFlow->getStepsInfo() << "\n";
+                                outputFile << "\n";  // Adauga un newline dupa terminarea pasilor
+                                outputFile.close();
+                            }
                             break;
                         }
                         // Verificare dacă input-ul este un număr între 1 și 10
@@ -953,21 +8555,8 @@ int main()
                                 getline(cin, description);
 
 
-                                NumberInputStep* numberInputStep = new NumberInputStep(description);
-
-                                // Executați pasul și verificați dacă a fost executat cu succes
-                                numberInputStep->execute();
-                                if (numberInputStep->isExecuted())
-                                {
-                                    selectedStep = numberInputStep;
-                                }
-                                else
-                                {
-
-                                    delete numberInputStep;
-                                    selectedStep = nullptr;
-                                }
-
+                                // Pasul este executat de addStepToFlow, o singura data
+                                selectedStep = createNumberInputStep(newFlow->getNumericMode(), description);
                                 break;
                             }
 
@@ -983,19 +8572,7 @@ int main()
                                 cout << "Introduceti operatia pentru CalculusStep: ";
                                 cin.ignore();
                                 getline(cin, operation);
-                                CalculusStep* calculusStep = new CalculusStep(steps, operation);
-
-                                // Adăugăm input-uri pentru CalculusStep
-                                for (int i = 0; i < steps; ++i)
-                                {
-                                    cout << "Adaugati input pentru pasul " << i + 1 << endl;
-                                    NumberInputStep* inputStep = new NumberInputStep("Descriere");
-                                    flowManager.addStepToFlow(newFlow, inputStep);
-                                    calculusStep->addInputStep(inputStep);
-                                    // Nu este necesar să rulezi flow-ul aici
-                                }
-
-                                selectedStep = calculusStep;
+                                selectedStep = createCalculusStep(newFlow->getNumericMode(), newFlow.get(), steps, operation);
                                 break;
                             }
 
@@ -1067,36 +8644,33 @@ int main()
                         if (selectedStep)
                         {
                             // Adaugarea pasului la flow
-                            flowManager.addStepToFlow(newFlow, selectedStep);
-                            newFlow->run();  // Executăm pasul adăugat imediat
+                            flowManager.addStepToFlow(newFlow.get(), selectedStep);  // Pasul adăugat este executat imediat
                         }
                         cout << "Alegeti urmatorul pas sau tasta 10 pentru a finaliza: ";
                     }
 
-                // Adăugăm procesul finalizat în manager
-                flowManager.addFlow(newFlow);
-                cout << "Procesul " << flowName << " a fost creat și finalizat cu succes!" << endl;
+                cout << "Procesul " << flowName << " a fost creat și finalizat cu succes!" << "\n";
                 // Salvare procese în fișier
-                flowManager.saveFlowsToFile("procese.txt");
+                flowManager.saveFlowsToFile(catalogFile);
 
 
                 if (newFlow != nullptr)
         {
             outputFile << newFlow->getStepsInfo() << "\n";
-            outputFile << endl;  // Adauga un newline dupa terminarea pasilor
+            outputFile << "\n";  // Adauga un newline dupa terminarea pasilor
         }
                 break;
             }
             case 2:
             {
                 cout << "Numele proceselor existente:\n";
-                for (const Flow* flow : flowManager.getFlows())
+                for (const string& name : flowManager.getFlowNames())
                 {
-                    cout << "- " << flow->getName() << endl;
+                    cout << "- " << name << "\n";
                 }
 
                 // Afișare procese din fișier
-                flowManager.displayFlowsFromFile("procese.txt");
+                flowManager.displayFlowsFromFile(catalogFile);
                 break;
             }
             case 3:
@@ -1104,16 +8678,20 @@ int main()
                 string flowName;
                 cout << "Introduceti numele procesului pe care doriti sa-l rulati: ";
                 cin >> flowName;
-                    Flow* selectedFlow = flowManager.getFlowByName(flowName);
+                    shared_ptr<Flow> selectedFlow = flowManager.getFlowByName(flowName);
                     if (selectedFlow)
                     {
                         cout << "Procesul: " << selectedFlow->getName() << "\n";
                         cout << "Pasi selectati: " << selectedFlow->getStepsInfo() << "\n";
-                        flowManager.runFlow(selectedFlow);
+                        RunOutcome outcome = flowManager.runFlow(selectedFlow.get());
+                        if (outcome.status == RunStatus::Failed)
+                        {
+                            cout << "Procesul " << flowName << " a esuat: " << outcome.error << "\n";
+                        }
                     }
                     else
                     {
-        cout << "Procesul cu numele " << flowName << " nu exista!" << endl;
+        cout << "Procesul cu numele " << flowName << " nu exista!" << "\n";
     }
     break;
             }
@@ -1122,15 +8700,13 @@ int main()
                 string flowName;
                 cout << "Introduceti numele procesului pe care doriti sa-l stergeti: ";
                 cin >> flowName;
-                Flow* selectedFlow = flowManager.getFlowByName(flowName);
-                if (selectedFlow)
+                if (flowManager.deleteFlow(flowName))
                 {
-                    flowManager.deleteFlow(selectedFlow);
-                    cout << "Procesul " << flowName << " a fost sters cu succes!" << endl;
+                    cout << "Procesul " << flowName << " a fost sters cu succes!" << "\n";
                 }
                 else
                 {
-                    cout << "Procesul cu numele " << flowName << " nu exista!" << endl;
+                    cout << "Procesul cu numele " << flowName << " nu exista!" << "\n";
                 }
                 break;
             }
@@ -1139,14 +8715,14 @@ int main()
                 string flowName;
                 cout << "Introduceti numele procesului pentru detalii: ";
                 cin >> flowName;
-                Flow* selectedFlow = flowManager.getFlowByName(flowName);
+                shared_ptr<Flow> selectedFlow = flowManager.getFlowByName(flowName);
                 if (selectedFlow)
                 {
                     selectedFlow->displayCreationTime();
                 }
                 else
                 {
-                    cout << "Procesul cu numele " << flowName << " nu exista!" << endl;
+                    cout << "Procesul cu numele " << flowName << " nu exista!" << "\n";
                 }
                 break;
             }
@@ -1155,27 +8731,186 @@ int main()
                 string flowName;
                 cout << "Introduceti numele procesului pentru analiza: ";
                 cin >> flowName;
-                Flow* selectedFlow = flowManager.getFlowByName(flowName);
+                shared_ptr<Flow> selectedFlow = flowManager.getFlowByName(flowName);
                 if (selectedFlow)
                 {
-                    flowManager.analyzeFlow(selectedFlow);
+                    flowManager.analyzeFlow(selectedFlow.get());
                 }
                 else
                 {
-                    cout << "Procesul cu numele " << flowName << " nu exista!" << endl;
+                    cout << "Procesul cu numele " << flowName << " nu exista!" << "\n";
+                }
+                break;
+            }
+            case 7:
+            {
+                string flowName, comparison;
+                size_t fromStep, targetStep;
+                double threshold;
+                cout << "Introduceti numele procesului: ";
+                cin >> flowName;
+                shared_ptr<Flow> selectedFlow = flowManager.getFlowByName(flowName);
+                if (!selectedFlow)
+                {
+                    cout << "Procesul cu numele " << flowName << " nu exista!" << "\n";
+                    break;
+                }
+                cout << "Dupa pasul (numarul pasului): ";
+                cin >> fromStep;
+                cout << "Comparatia cu rezultatul pasului (<, <=, >, >=, ==, !=): ";
+                cin >> comparison;
+                cout << "Valoarea de comparat: ";
+                cin >> threshold;
+                cout << "Sari la pasul (numarul pasilor + 1 pentru final): ";
+                cin >> targetStep;
+                if (cin.fail() || fromStep == 0 || targetStep == 0)
+                {
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    cout << "Date invalide pentru salt." << "\n";
+                    break;
+                }
+                try
+                {
+                    selectedFlow->addTransition(fromStep - 1, comparison, threshold, targetStep - 1);
+                    cout << "Saltul a fost adaugat in versiunea " << selectedFlow->getVersionNumber() << "\n";
+                }
+                catch (const invalid_argument& e)
+                {
+                    cout << "Eroare: " << e.what() << "\n";
+                }
+                break;
+            }
+            case 8:
+            {
+                string flowName;
+                size_t stepNumber;
+                long long timeoutMs, backoffMs;
+                StepPolicy policy;
+                cout << "Introduceti numele procesului: ";
+                cin >> flowName;
+                shared_ptr<Flow> selectedFlow = flowManager.getFlowByName(flowName);
+                if (!selectedFlow)
+                {
+                    cout << "Procesul cu numele " << flowName << " nu exista!" << "\n";
+                    break;
+                }
+                cout << "Numarul pasului: ";
+                cin >> stepNumber;
+                cout << "Numarul maxim de incercari: ";
+                cin >> policy.maxAttempts;
+                cout << "Timpul maxim al unei incercari in ms (0 = fara limita): ";
+                cin >> timeoutMs;
+                cout << "Asteptarea dupa prima incercare esuata in ms: ";
+                cin >> backoffMs;
+                if (cin.fail() || stepNumber == 0 || policy.maxAttempts < 1 || timeoutMs < 0 || backoffMs < 0)
+                {
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                    cout << "Date invalide pentru politica." << "\n";
+                    break;
+                }
+                policy.timeout = chrono::milliseconds(timeoutMs);
+                policy.backoff = chrono::milliseconds(backoffMs);
+                try
+                {
+                    selectedFlow->setStepPolicy(stepNumber - 1, policy);
+                    cout << "Politica a fost setata in versiunea " << selectedFlow->getVersionNumber() << "\n";
+                }
+                catch (const out_of_range& e)
+                {
+                    cout << "Eroare: " << e.what() << "\n";
+                }
+                break;
+            }
+
+            case 9:
+            {
+                flowManager.analyzeAll().print(cout);
+                break;
+            }
+            case 10:
+            {
+                string query;
+                cout << "Introduceti termenii cautarii: ";
+                cin.ignore();
+                getline(cin, query);
+
+                // Termenii intre ghilimele pot contine spatii
+                vector<string> found = flowManager.searchFlows(StepIndex::parseQuery(query));
+                cout << "Procese gasite: " << found.size() << "\n";
+                for (const string& flowName : found)
+                {
+                    cout << "- " << flowName << "\n";
                 }
                 break;
             }
+            case 11:
+            {
+                string source;
+                vector<RunTrace> traces;
+                cout << "Introduceti fisierul de urme sau numele unui proces pentru urme sintetice: ";
+                cin >> source;
+
+                shared_ptr<Flow> flow = flowManager.getFlowByName(source);
+                try
+                {
+                    traces = flow ? LoadGenerator::synthesize(*flow, 1000, 1) : TraceLog::load(source);
+                }
+                catch (const runtime_error& e)
+                {
+                    cout << "Eroare: " << e.what() << "\n";
+                    break;
+                }
+
+                size_t runs, concurrency;
+                double rate;
+                cout << "Numarul de rulari: ";
+                cin >> runs;
+                cout << "Numarul de thread-uri: ";
+                cin >> concurrency;
+                cout << "Rata (rulari pe secunda, 0 pentru maxim): ";
+                cin >> rate;
+
+                // Continutul afisat de pasi nu ajunge in consola in timpul testului
+                unique_ptr<OutputSink> consoleSink = move(outputSink);
+                outputSink.reset(new NullSink());
+                LoadGenerator generator(flowManager, concurrency, rate);
+                LoadReport report = generator.run(traces, runs);
+                outputSink = move(consoleSink);
+                report.print(cout);
+                break;
+            }
+            case 12:
+            {
+                string fileName;
+                cout << "Introduceti numele fisierului de import: ";
+                cin >> fileName;
+                reportImport(FlowImporter(flowManager).importFile(fileName), catalogFile);
+                break;
+            }
+            case 13:
+                flowManager.enforceMemoryBudget(true);
+                flowManager.memoryReport().print(cout);
+                break;
+            case 14:
+                if (!executionTracer)
+                {
+                    cout << "Cronologia nu este inregistrata; porniti programul cu --trace-out <fisier.json>.\n";
+                    break;
+                }
+                exportExecutionTrace(traceOutFile);
+                break;
 
             default:
-                cout << "Optiune invalida. Va rugam sa reintroduceti optiunea." << endl;
+                cout << "Optiune invalida. Va rugam sa reintroduceti optiunea." << "\n";
             }
         }
         outputFile.close();  // Inchide fisierul dupa ce ai terminat cu toate operatiunile
     }
     catch (const exception& e)
     {
-        cerr << "Eroare: " << e.what() << endl;
+        cerr << "Eroare: " << e.what() << "\n";
     }
 
 